@@ -0,0 +1,246 @@
+/*
+  ==============================================================================
+
+    AnalyzerComponent.cpp
+
+  ==============================================================================
+*/
+
+#include "AnalyzerComponent.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+AnalyzerComponent::AnalyzerComponent(HarmonicsAnalysis& analysis)
+	: m_analysis(analysis),
+	  m_history(FFT_SIZE, 0.0f),
+	  m_scratch(HarmonicsAnalysis::scopeCapacity, 0.0f),
+	  m_fftData(2 * FFT_SIZE, 0.0f),
+	  m_frameClock(*this, FRAME_RATE, [this] { update(); })
+{
+	std::fill(std::begin(m_spectrum), std::end(m_spectrum), MIN_DB);
+	setOpaque(true);
+
+	// Processor meters only while something shows it
+	m_analysis.setEnabled(true);
+	m_frameClock.onVisibilityChange = [this](bool showing) { m_analysis.setEnabled(showing); };
+}
+
+AnalyzerComponent::~AnalyzerComponent()
+{
+	m_analysis.setEnabled(false);
+}
+
+//==============================================================================
+void AnalyzerComponent::update()
+{
+	// Levels, everything published since the last frame
+	float rms[HarmonicsMeter::numLevels] = {};
+	float peak[HarmonicsMeter::numLevels] = {};
+	HarmonicsAnalysis::Levels levels;
+
+	while (m_analysis.popLevels(levels))
+	{
+		for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+		{
+			rms[level] = juce::jmax(rms[level], levels.rms[level]);
+			peak[level] = juce::jmax(peak[level], levels.peak[level]);
+		}
+	}
+
+	for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+	{
+		m_rms[level] = juce::jmax(rms[level], m_rms[level] * METER_DECAY);
+		m_peak[level] = juce::jmax(peak[level], m_peak[level] * METER_DECAY);
+
+		const auto pixels = getMeterPixels(level);
+
+		if (pixels != m_paintedMeters[level])
+		{
+			repaint(m_meterAreas[level].getSmallestIntegerContainer());
+		}
+	}
+
+	// Output samples, only the newest FFT_SIZE matter
+	const int popped = m_analysis.popScope(m_scratch.data(), (int)m_scratch.size());
+
+	for (int i = juce::jmax(0, popped - FFT_SIZE); i < popped; ++i)
+	{
+		m_history[m_historyPosition] = m_scratch[i];
+		m_historyPosition = (m_historyPosition + 1) % FFT_SIZE;
+	}
+
+	// Silence keeps the history at zero, once the curve has decayed there is nothing to redraw
+	if (popped > 0 || ! m_spectrumSilent)
+	{
+		m_spectrumSilent = ! updateSpectrum();
+		repaint(m_spectrumArea.getSmallestIntegerContainer());
+	}
+}
+
+bool AnalyzerComponent::updateSpectrum()
+{
+	// Oldest sample first
+	std::copy(m_history.begin() + m_historyPosition, m_history.end(), m_fftData.begin());
+	std::copy(m_history.begin(), m_history.begin() + m_historyPosition, m_fftData.begin() + (FFT_SIZE - m_historyPosition));
+
+	m_window.multiplyWithWindowingTable(m_fftData.data(), FFT_SIZE);
+	m_fft.performFrequencyOnlyForwardTransform(m_fftData.data());
+
+	// Full scale sine reads 0 dB, Hann window halves the bin magnitude
+	const float scale = 4.0f / (float)FFT_SIZE;
+	const float binWidth = (float)m_analysis.getSampleRate() / (float)FFT_SIZE;
+	const float frequencyRatio = MAX_FREQUENCY / MIN_FREQUENCY;
+
+	bool audible = false;
+
+	for (int point = 0; point < SPECTRUM_POINTS; ++point)
+	{
+		const float frequency = MIN_FREQUENCY * std::pow(frequencyRatio, (float)point / (float)(SPECTRUM_POINTS - 1));
+		const float bin = juce::jlimit(0.0f, (float)(FFT_SIZE / 2 - 1), frequency / binWidth);
+
+		const int index = (int)bin;
+		const float fraction = bin - (float)index;
+		const float magnitude = m_fftData[index] + fraction * (m_fftData[index + 1] - m_fftData[index]);
+
+		const float decibels = toDecibels(scale * magnitude);
+		m_spectrum[point] = juce::jmax(decibels, MIN_DB + (m_spectrum[point] - MIN_DB) * SPECTRUM_DECAY);
+
+		// Within a tenth of a dB of the floor is drawn on the floor
+		audible = audible || m_spectrum[point] > MIN_DB + 0.1f;
+	}
+
+	return audible;
+}
+
+juce::Point<int> AnalyzerComponent::getMeterPixels(int level) const
+{
+	const auto& meter = m_meterAreas[level];
+
+	const float rmsY = juce::jmap(toDecibels(m_rms[level]), MIN_DB, 0.0f, meter.getBottom(), meter.getY());
+	const float peakY = juce::jmap(toDecibels(m_peak[level]), MIN_DB, 0.0f, meter.getBottom(), meter.getY());
+
+	return { (int)rmsY, (int)peakY };
+}
+
+//==============================================================================
+void AnalyzerComponent::resized()
+{
+	auto area = getLocalBounds().toFloat().reduced(4.0f);
+	auto meterArea = area.removeFromRight(area.getWidth() * 0.3f);
+	area.removeFromRight(4.0f);
+
+	m_spectrumArea = area;
+
+	const float width = meterArea.getWidth() / (float)HarmonicsMeter::numLevels;
+
+	for (auto& meter : m_meterAreas)
+	{
+		meter = meterArea.removeFromLeft(width).reduced(2.0f, 0.0f);
+	}
+
+	updateBackground();
+}
+
+void AnalyzerComponent::updateBackground()
+{
+	static const char* names[HarmonicsMeter::numLevels] = { "2", "4", "6", "8", "Sum", "Clip", "Pre", "Post" };
+
+	// Physical pixels, so the cached image stays sharp on scaled displays
+	const float scale = juce::Component::getApproximateScaleFactorForComponent(this);
+	const int width = juce::jmax(1, juce::roundToInt(getWidth() * scale));
+	const int height = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+
+	m_background = juce::Image(juce::Image::RGB, width, height, false);
+
+	juce::Graphics g(m_background);
+	g.addTransform(juce::AffineTransform::scale(scale));
+	g.fillAll(HarmonicsAudioProcessorEditor::dark);
+
+	// Octave grid
+	g.setColour(HarmonicsAudioProcessorEditor::medium);
+
+	for (float frequency = 31.25f; frequency < MAX_FREQUENCY; frequency *= 2.0f)
+	{
+		const float x = m_spectrumArea.getX() + m_spectrumArea.getWidth() * std::log(frequency / MIN_FREQUENCY) / std::log(MAX_FREQUENCY / MIN_FREQUENCY);
+		g.drawVerticalLine((int)x, m_spectrumArea.getY(), m_spectrumArea.getBottom());
+	}
+
+	// Meter backgrounds with their labels underneath, the bars end above the labels
+	const float labelHeight = 14.0f;
+	g.setFont(juce::Font(labelHeight * 0.9f));
+
+	for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+	{
+		auto& meter = m_meterAreas[level];
+		const auto label = meter.removeFromBottom(labelHeight);
+
+		g.setColour(HarmonicsAudioProcessorEditor::veryLight);
+		g.drawText(names[level], label, juce::Justification::centred);
+
+		g.setColour(HarmonicsAudioProcessorEditor::medium);
+		g.fillRect(meter);
+
+		m_paintedMeters[level] = { -1, -1 };
+	}
+}
+
+//==============================================================================
+void AnalyzerComponent::paint(juce::Graphics& g)
+{
+	// JUCE clips to the dirty region, only that part of the background is copied
+	g.drawImage(m_background, getLocalBounds().toFloat());
+
+	if (g.clipRegionIntersects(m_spectrumArea.getSmallestIntegerContainer()))
+	{
+		paintSpectrum(g);
+	}
+
+	paintMeters(g);
+}
+
+void AnalyzerComponent::paintSpectrum(juce::Graphics& g)
+{
+	const auto& area = m_spectrumArea;
+	juce::Path path;
+
+	for (int point = 0; point < SPECTRUM_POINTS; ++point)
+	{
+		const float x = area.getX() + area.getWidth() * (float)point / (float)(SPECTRUM_POINTS - 1);
+		const float y = juce::jmap(m_spectrum[point], MIN_DB, 0.0f, area.getBottom(), area.getY());
+
+		if (point == 0)
+		{
+			path.startNewSubPath(x, y);
+		}
+		else
+		{
+			path.lineTo(x, y);
+		}
+	}
+
+	g.setColour(HarmonicsAudioProcessorEditor::veryLight);
+	g.strokePath(path, juce::PathStrokeType(1.5f));
+}
+
+void AnalyzerComponent::paintMeters(juce::Graphics& g)
+{
+	for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+	{
+		const auto& meter = m_meterAreas[level];
+
+		if (! g.clipRegionIntersects(meter.getSmallestIntegerContainer()))
+		{
+			continue;
+		}
+
+		// RMS bar and peak line
+		const auto pixels = getMeterPixels(level);
+		m_paintedMeters[level] = pixels;
+
+		g.setColour(HarmonicsAudioProcessorEditor::light);
+		g.fillRect(meter.withTop((float)pixels.x));
+
+		g.setColour(HarmonicsAudioProcessorEditor::veryLight);
+		g.drawHorizontalLine(pixels.y, meter.getX(), meter.getRight());
+	}
+}
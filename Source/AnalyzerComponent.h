@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    AnalyzerComponent.h
+    Harmonic and limiter meters with an output spectrum, drawn from the data
+    the processor publishes through HarmonicsAnalysis.
+
+    Grid, meter backgrounds and labels are drawn once per size into an
+    image. Frames come from FrameClock and repaint only the meters whose
+    bars moved by a pixel and the spectrum while it changes, a silent input
+    stops repainting once everything has decayed. While hidden the
+    processor stops metering.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FrameClock.h"
+#include "HarmonicsAnalysis.h"
+
+//==============================================================================
+class AnalyzerComponent : public juce::Component
+{
+public:
+	AnalyzerComponent(HarmonicsAnalysis& analysis);
+	~AnalyzerComponent() override;
+
+	static const int FRAME_RATE = 30;
+	static const int FFT_ORDER = 11;
+	static const int FFT_SIZE = 1 << FFT_ORDER;
+	static const int SPECTRUM_POINTS = 256;
+
+	static constexpr float MIN_DB = -90.0f;
+	static constexpr float MIN_FREQUENCY = 20.0f;
+	static constexpr float MAX_FREQUENCY = 20000.0f;
+
+	// Per frame display decay
+	static constexpr float SPECTRUM_DECAY = 0.8f;
+	static constexpr float METER_DECAY = 0.85f;
+
+	//==============================================================================
+	void paint(juce::Graphics&) override;
+	void resized() override;
+
+private:
+	void update();
+	bool updateSpectrum();
+	void updateBackground();
+	void paintMeters(juce::Graphics& g);
+	void paintSpectrum(juce::Graphics& g);
+
+	// Bar and peak line of a meter in pixels, from the top of its area
+	juce::Point<int> getMeterPixels(int level) const;
+
+	static float toDecibels(float gain) { return juce::jmax(MIN_DB, juce::Decibels::gainToDecibels(gain, MIN_DB)); };
+
+	//==============================================================================
+	HarmonicsAnalysis& m_analysis;
+
+	juce::dsp::FFT m_fft { FFT_ORDER };
+	juce::dsp::WindowingFunction<float> m_window { FFT_SIZE, juce::dsp::WindowingFunction<float>::hann };
+
+	// Newest output samples, circular
+	std::vector<float> m_history;
+	int m_historyPosition = 0;
+
+	std::vector<float> m_scratch;
+	std::vector<float> m_fftData;
+
+	float m_spectrum[SPECTRUM_POINTS] = {};
+	float m_rms[HarmonicsMeter::numLevels] = {};
+	float m_peak[HarmonicsMeter::numLevels] = {};
+
+	// Layout and the static parts, rebuilt in resized()
+	juce::Rectangle<float> m_spectrumArea;
+	juce::Rectangle<float> m_meterAreas[HarmonicsMeter::numLevels];
+	juce::Image m_background;
+
+	// What the last paint showed, repaints are skipped while it stays the same
+	juce::Point<int> m_paintedMeters[HarmonicsMeter::numLevels];
+	bool m_spectrumSilent = true;
+
+	FrameClock m_frameClock;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalyzerComponent)
+};
@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    ChebyshevShaper.h
+    Waveshaper producing any set of harmonics up to the 16th from a single
+    polynomial, sum of level_k * T_k(x) over the Chebyshev polynomials T_k.
+
+    A full scale sine cos(t) comes out as level_k * cos(k * t) for every
+    harmonic k, quieter input gives proportionally less of the higher ones.
+    The polynomial is evaluated with the Clenshaw recurrence directly on the
+    Chebyshev coefficients, which stays accurate in float where the expanded
+    power series (leading coefficient 2^15 for T_16) would cancel badly.
+    Cost is one multiply and two adds per degree, the degree follows the
+    highest harmonic with a non-zero level.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SIMDVector.h"
+
+//==============================================================================
+// Harmonic levels, index is the harmonic number, 0 and 1 are unused
+struct ChebyshevLevels
+{
+	static const int maxHarmonic = 16;
+
+	float level[maxHarmonic + 1] = {};
+
+	bool operator==(const ChebyshevLevels& other) const
+	{
+		for (int harmonic = 0; harmonic <= maxHarmonic; ++harmonic)
+		{
+			if (level[harmonic] != other.level[harmonic])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool operator!=(const ChebyshevLevels& other) const { return ! (*this == other); };
+};
+
+//==============================================================================
+template <typename Vec>
+class ChebyshevShaper
+{
+public:
+	using Sample = typename Vec::Sample;
+
+	static const int maxHarmonic = ChebyshevLevels::maxHarmonic;
+
+	ChebyshevShaper() { reset(); };
+
+	// All levels at zero, output is silent
+	void reset();
+
+	// Recomputes the coefficient table when the levels changed,
+	// the coefficients then ramp to it over rampSamples
+	void setLevels(const ChebyshevLevels& levels, int rampSamples);
+	void jumpToTarget();
+
+	bool isRamping() const { return m_rampSamples > 0; };
+	int getRampSamples() const { return m_rampSamples; };
+	bool isSilent() const { return m_rampSamples == 0 && m_degree == 0; };
+	int getDegree() const { return m_degree; };
+
+	// One ramp step, for the dynamic kernel variants
+	void advance();
+
+	// Input must be within -1..1, silence maps to silence
+	Vec process(Vec x) const;
+
+protected:
+	void calculateTarget(const ChebyshevLevels& levels);
+
+	ChebyshevLevels m_levels;
+
+	Sample m_target[maxHarmonic + 1] = {};
+	Vec m_coefs[maxHarmonic + 1];
+	Vec m_steps[maxHarmonic + 1];
+
+	int m_degree = 0;
+	int m_targetDegree = 0;
+	int m_rampSamples = 0;
+};
+
+template <typename Vec>
+inline void ChebyshevShaper<Vec>::calculateTarget(const ChebyshevLevels& levels)
+{
+	m_levels = levels;
+	m_targetDegree = 0;
+
+	// T_k(0) is cos(k * pi / 2), the constant term cancels it so silence stays silent
+	Sample constant = Sample(0);
+
+	for (int harmonic = 2; harmonic <= maxHarmonic; ++harmonic)
+	{
+		const Sample level = (Sample)levels.level[harmonic];
+		m_target[harmonic] = level;
+
+		if (level != Sample(0))
+		{
+			m_targetDegree = harmonic;
+		}
+
+		if (harmonic % 2 == 0)
+		{
+			constant += (harmonic % 4 == 0) ? level : -level;
+		}
+	}
+
+	m_target[0] = -constant;
+	m_target[1] = Sample(0);
+}
+
+template <typename Vec>
+inline void ChebyshevShaper<Vec>::reset()
+{
+	calculateTarget(ChebyshevLevels());
+	jumpToTarget();
+}
+
+template <typename Vec>
+inline void ChebyshevShaper<Vec>::setLevels(const ChebyshevLevels& levels, int rampSamples)
+{
+	if (levels == m_levels)
+	{
+		return;
+	}
+
+	calculateTarget(levels);
+
+	if (rampSamples <= 0)
+	{
+		jumpToTarget();
+		return;
+	}
+
+	alignas(16) Sample current[Vec::size];
+
+	for (int k = 0; k <= maxHarmonic; ++k)
+	{
+		m_coefs[k].store(current);
+		m_steps[k] = Vec::broadcast((m_target[k] - current[0]) / (Sample)rampSamples);
+	}
+
+	// Harmonics fading out keep running until the ramp is done
+	m_degree = m_degree > m_targetDegree ? m_degree : m_targetDegree;
+	m_rampSamples = rampSamples;
+}
+
+template <typename Vec>
+inline void ChebyshevShaper<Vec>::jumpToTarget()
+{
+	for (int k = 0; k <= maxHarmonic; ++k)
+	{
+		m_coefs[k] = Vec::broadcast(m_target[k]);
+		m_steps[k] = Vec::broadcast(Sample(0));
+	}
+
+	m_degree = m_targetDegree;
+	m_rampSamples = 0;
+}
+
+template <typename Vec>
+inline void ChebyshevShaper<Vec>::advance()
+{
+	if (m_rampSamples == 0)
+	{
+		return;
+	}
+
+	for (int k = 0; k <= m_degree; ++k)
+	{
+		m_coefs[k] = m_coefs[k] + m_steps[k];
+	}
+
+	// Last step lands exactly on the table
+	if (--m_rampSamples == 0)
+	{
+		jumpToTarget();
+	}
+}
+
+template <typename Vec>
+inline Vec ChebyshevShaper<Vec>::process(Vec x) const
+{
+	// Clenshaw: b_k = c_k + 2x * b_k+1 - b_k+2, result c_0 + x * b_1 - b_2
+	const Vec twoX = x + x;
+
+	Vec b1 = Vec::broadcast(Sample(0));
+	Vec b2 = Vec::broadcast(Sample(0));
+
+	for (int k = m_degree; k >= 1; --k)
+	{
+		const Vec b0 = m_coefs[k] + twoX * b1 - b2;
+		b2 = b1;
+		b1 = b0;
+	}
+
+	return m_coefs[0] + x * b1 - b2;
+}
@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    FastMath.h
+    Exact and fast tiers of the transcendental functions the DSP uses.
+
+    ExactMath calls libm. FastMath has polynomial approximations without
+    branches or table lookups, written on the SIMDVector types so a kernel
+    gets them for all its lanes at once. The float overloads run them on
+    FloatVec1, except exp2, exp and pow, a single one of those is no faster
+    than libm and calls ExactMath:
+
+      exp2      Range reduced to 2^n * 2^f with |f| <= 1/2, Taylor series of
+                degree 7 for 2^f, 2^n built in the exponent bits
+      log2      Mantissa folded onto sqrt(1/2)..sqrt(2), series of atanh
+                in (m - 1) / (m + 1) up to the 9th power
+      exp, log, pow, decibelsToGain and gainToDecibels scale those two
+
+    The largest errors of float lanes are below, each over its range against
+    a double reference, double lanes stay within them. HarmonicsCoreBenchmark
+    --check-math measures them again and times both tiers.
+
+    exp2 rounds with an addition the compiler must not reassociate, so
+    FastMath needs IEEE arithmetic and no fast-math compiler flags.
+
+    HarmonicsMath is the tier the DSP calls. It is ExactMath unless
+    HARMONICS_FAST_MATH is defined to 1, the CMake option of the same name
+    does that.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include "SIMDVector.h"
+
+#ifndef HARMONICS_FAST_MATH
+ #define HARMONICS_FAST_MATH 0
+#endif
+
+//==============================================================================
+namespace ExactMath
+{
+	inline float exp2(float x)						{ return exp2f(x); }
+	inline float log2(float x)						{ return log2f(x); }
+	inline float exp(float x)						{ return expf(x); }
+	inline float log(float x)						{ return logf(x); }
+	inline float pow(float base, float exponent)	{ return powf(base, exponent); }
+	inline float decibelsToGain(float decibels)		{ return powf(10.0f, decibels * 0.05f); }
+	inline float gainToDecibels(float gain)			{ return 20.0f * log10f(gain); }
+}
+
+//==============================================================================
+namespace FastMath
+{
+	// Relative error, -126 <= x <= 127
+	constexpr float EXP2_MAX_ERROR = 2.5e-7f;
+	// Absolute error over max(1, |log2 x|), positive normal x
+	constexpr float LOG2_MAX_ERROR = 2.5e-7f;
+	// Relative error, -80 <= x <= 80
+	constexpr float EXP_MAX_ERROR = 5.0e-6f;
+	// Absolute error over max(1, |log x|), positive normal x
+	constexpr float LOG_MAX_ERROR = 2.5e-7f;
+	// Relative error, 1e-3 <= base <= 1e3 and |exponent * log2 base| <= 20
+	constexpr float POW_MAX_ERROR = 5.0e-6f;
+	// In dB, -100 to +40 dB and 1e-5 to 100 gain
+	constexpr float DECIBELS_MAX_ERROR = 2.0e-5f;
+
+	template <typename Vec>
+	inline Vec exp2(Vec x)
+	{
+		using Sample = typename Vec::Sample;
+
+		x = Vec::min(Vec::max(x, Vec::broadcast(Sample(-126))), Vec::broadcast(Sample(127)));
+
+		// Adding 1.5 * 2^23, or 2^52 for double, leaves no fraction bits, so this rounds to the nearest integer
+		const Vec round = Vec::broadcast(sizeof(Sample) == sizeof(float) ? Sample(12582912.0) : Sample(6755399441055744.0));
+		const Vec rounded = (x + round) - round;
+		const Vec f = x - rounded;
+
+		// sum (f ln 2)^k / k!, k = 0..7
+		Vec p = Vec::broadcast(Sample(1.5252733804059841e-5));
+		p = p * f + Vec::broadcast(Sample(1.5403530393381609e-4));
+		p = p * f + Vec::broadcast(Sample(1.3333558146428443e-3));
+		p = p * f + Vec::broadcast(Sample(9.6181291076284772e-3));
+		p = p * f + Vec::broadcast(Sample(5.5504108664821580e-2));
+		p = p * f + Vec::broadcast(Sample(2.4022650695910071e-1));
+		p = p * f + Vec::broadcast(Sample(6.9314718055994531e-1));
+		p = p * f + Vec::broadcast(Sample(1));
+
+		return p * powerOfTwo(rounded);
+	}
+
+	template <typename Vec>
+	inline Vec log2(Vec x)
+	{
+		using Sample = typename Vec::Sample;
+
+		Vec exponent;
+		const Vec m = splitExponent(x, exponent);
+
+		// log2(m) = 2 / ln 2 * (t + t^3/3 + ... + t^9/9), |t| < 0.172 for m in sqrt(1/2)..sqrt(2)
+		const Vec one = Vec::broadcast(Sample(1));
+		const Vec t = (m - one) / (m + one);
+		const Vec t2 = t * t;
+
+		Vec s = Vec::broadcast(Sample(1.0 / 9.0));
+		s = s * t2 + Vec::broadcast(Sample(1.0 / 7.0));
+		s = s * t2 + Vec::broadcast(Sample(1.0 / 5.0));
+		s = s * t2 + Vec::broadcast(Sample(1.0 / 3.0));
+		s = s * t2 * t + t;
+
+		return exponent + s * Vec::broadcast(Sample(2.8853900817779268));
+	}
+
+	template <typename Vec>
+	inline Vec exp(Vec x)						{ return exp2(x * Vec::broadcast(typename Vec::Sample(1.4426950408889634))); }
+
+	template <typename Vec>
+	inline Vec log(Vec x)						{ return log2(x) * Vec::broadcast(typename Vec::Sample(0.69314718055994531)); }
+
+	// base > 0
+	template <typename Vec>
+	inline Vec pow(Vec base, Vec exponent)		{ return exp2(exponent * log2(base)); }
+
+	// No floor, -inf dB is the caller's to handle
+	template <typename Vec>
+	inline Vec decibelsToGain(Vec decibels)	{ return exp2(decibels * Vec::broadcast(typename Vec::Sample(0.16609640474436813))); }
+
+	template <typename Vec>
+	inline Vec gainToDecibels(Vec gain)		{ return log2(gain) * Vec::broadcast(typename Vec::Sample(6.0205999132796239)); }
+
+	// Scalar float through the single lane vector, libm where that is as fast
+	inline float exp2(float x)						{ return ExactMath::exp2(x); }
+	inline float log2(float x)						{ return log2(FloatVec1 { x }).v; }
+	inline float exp(float x)						{ return ExactMath::exp(x); }
+	inline float log(float x)						{ return log(FloatVec1 { x }).v; }
+	inline float pow(float base, float exponent)	{ return ExactMath::pow(base, exponent); }
+	inline float decibelsToGain(float decibels)		{ return decibelsToGain(FloatVec1 { decibels }).v; }
+	inline float gainToDecibels(float gain)			{ return gainToDecibels(FloatVec1 { gain }).v; }
+}
+
+#if HARMONICS_FAST_MATH
+namespace HarmonicsMath = FastMath;
+#else
+namespace HarmonicsMath = ExactMath;
+#endif
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    FastTrig.h
+    Sine and cosine for coefficient calculation, cheaper than the two libm
+    calls and without their argument reduction for huge inputs.
+
+    Both are Taylor polynomials in double on 0..pi/4, the rest of -pi..pi is
+    folded onto that range. The truncation error there is below 5e-17, so the
+    result stays within a few double ulp of the exact value and rounding it
+    to float gives the correctly rounded float.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//==============================================================================
+namespace FastTrig
+{
+	// Valid for -pi <= x <= pi
+	inline void sinCos(double x, double& sine, double& cosine)
+	{
+		const double pi = 3.14159265358979323846;
+		const double halfPi = 1.57079632679489661923;
+		const double quarterPi = 0.78539816339744830962;
+
+		const bool negative = x < 0.0;
+		x = negative ? -x : x;
+
+		// sin(pi - x) = sin(x), cos(pi - x) = -cos(x)
+		const bool mirrored = x > halfPi;
+		x = mirrored ? pi - x : x;
+
+		// sin(pi/2 - x) = cos(x)
+		const bool swapped = x > quarterPi;
+		x = swapped ? halfPi - x : x;
+
+		const double x2 = x * x;
+
+		// x - x^3/3! + ... - x^15/15!
+		double s = -1.0 / 1307674368000.0;
+		s = s * x2 + 1.0 / 6227020800.0;
+		s = s * x2 - 1.0 / 39916800.0;
+		s = s * x2 + 1.0 / 362880.0;
+		s = s * x2 - 1.0 / 5040.0;
+		s = s * x2 + 1.0 / 120.0;
+		s = s * x2 - 1.0 / 6.0;
+		s = s * x2 * x + x;
+
+		// 1 - x^2/2! + ... + x^16/16!
+		double c = 1.0 / 20922789888000.0;
+		c = c * x2 - 1.0 / 87178291200.0;
+		c = c * x2 + 1.0 / 479001600.0;
+		c = c * x2 - 1.0 / 3628800.0;
+		c = c * x2 + 1.0 / 40320.0;
+		c = c * x2 - 1.0 / 720.0;
+		c = c * x2 + 1.0 / 24.0;
+		c = c * x2 - 1.0 / 2.0;
+		c = c * x2 + 1.0;
+
+		const double sinX = swapped ? c : s;
+		const double cosX = swapped ? s : c;
+
+		sine = negative ? -sinX : sinX;
+		cosine = mirrored ? -cosX : cosX;
+	}
+
+	template <typename SampleType>
+	inline void sinCos(SampleType x, SampleType& sine, SampleType& cosine)
+	{
+		double s, c;
+		sinCos((double)x, s, c);
+
+		sine = (SampleType)s;
+		cosine = (SampleType)c;
+	}
+}
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    FrameClock.h
+    Frame callbacks for animated editor parts, aligned to the display
+    refresh and throttled to a fixed rate.
+
+    The callbacks come from juce::VBlankAttachment, so they arrive with the
+    display refresh JUCE already runs for every window instead of from one
+    timer per component. A frame is due when the time crosses into a new
+    1 / frameRate slot. The slots are the same for every clock, so all open
+    editors with the same rate update in the same refresh and the host
+    composites once.
+
+    While the component is not showing (window hidden, minimised or on
+    another tab) nothing is called except onVisibilityChange, which lets the
+    owner stop the processor feeding it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class FrameClock
+{
+public:
+	FrameClock(juce::Component& component, int frameRate, std::function<void()> onFrame)
+		: m_component(component),
+		  m_frameRate(frameRate),
+		  m_onFrame(std::move(onFrame)),
+		  m_vBlank(&component, [this] { tick(); })
+	{
+	};
+
+	// Called with the new state when the component starts or stops showing
+	std::function<void(bool showing)> onVisibilityChange;
+
+private:
+	void tick()
+	{
+		const bool showing = m_component.isShowing();
+
+		if (showing != m_showing)
+		{
+			m_showing = showing;
+
+			if (onVisibilityChange != nullptr)
+			{
+				onVisibilityChange(showing);
+			}
+		}
+
+		if (! showing)
+		{
+			return;
+		}
+
+		const auto frame = (juce::int64)(juce::Time::getMillisecondCounterHiRes() * 0.001 * m_frameRate);
+
+		if (frame != m_lastFrame)
+		{
+			m_lastFrame = frame;
+			m_onFrame();
+		}
+	};
+
+	juce::Component& m_component;
+	const int m_frameRate;
+	std::function<void()> m_onFrame;
+
+	juce::int64 m_lastFrame = -1;
+	bool m_showing = true;
+
+	juce::VBlankAttachment m_vBlank;
+
+	JUCE_DECLARE_NON_COPYABLE(FrameClock)
+};
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    HarmonicsAnalysis.h
+    Levels and output samples handed from the audio thread to the editor.
+
+    Both streams go through juce::AbstractFifo, which is wait-free for one
+    producer and one consumer, into storage allocated up front, so the audio
+    thread never locks or allocates. When a FIFO is full the new data is
+    dropped. Nothing is measured or pushed unless the editor enabled it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "HarmonicsKernel.h"
+
+//==============================================================================
+class HarmonicsAnalysis
+{
+public:
+	static const int levelsCapacity = 512;
+	static const int scopeCapacity = 1 << 15;
+
+	struct Levels
+	{
+		float rms[HarmonicsMeter::numLevels] = {};
+		float peak[HarmonicsMeter::numLevels] = {};
+	};
+
+	HarmonicsAnalysis();
+
+	void setEnabled(bool enabled) { m_enabled.store(enabled); };
+	bool isEnabled() const { return m_enabled.load(); };
+
+	void setSampleRate(double sampleRate) { m_sampleRate.store(sampleRate); };
+	double getSampleRate() const { return m_sampleRate.load(); };
+
+	// Audio thread
+	void pushLevels(const HarmonicsMeter& meter);
+
+	// Mono sum of the output
+	template <typename SampleType>
+	void pushScope(const SampleType* const* channels, int numChannels, int samples);
+
+	// Message thread
+	bool popLevels(Levels& levels);
+	int popScope(float* dest, int maxSamples);
+
+protected:
+	std::atomic<bool> m_enabled { false };
+	std::atomic<double> m_sampleRate { 48000.0 };
+
+	juce::AbstractFifo m_levelsFifo { levelsCapacity };
+	std::vector<Levels> m_levels;
+
+	juce::AbstractFifo m_scopeFifo { scopeCapacity };
+	std::vector<float> m_scope;
+};
+
+inline HarmonicsAnalysis::HarmonicsAnalysis()
+	: m_levels(levelsCapacity), m_scope(scopeCapacity, 0.0f)
+{
+}
+
+inline void HarmonicsAnalysis::pushLevels(const HarmonicsMeter& meter)
+{
+	int start1, size1, start2, size2;
+	m_levelsFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+	if (size1 == 0)
+	{
+		return;
+	}
+
+	auto& levels = m_levels[start1];
+
+	for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+	{
+		levels.rms[level] = meter.samples > 0 ? std::sqrt(meter.sumSquares[level] / (float)meter.samples) : 0.0f;
+		levels.peak[level] = meter.peak[level];
+	}
+
+	m_levelsFifo.finishedWrite(1);
+}
+
+template <typename SampleType>
+inline void HarmonicsAnalysis::pushScope(const SampleType* const* channels, int numChannels, int samples)
+{
+	int start1, size1, start2, size2;
+	m_scopeFifo.prepareToWrite(samples, start1, size1, start2, size2);
+
+	const float scale = 1.0f / (float)juce::jmax(1, numChannels);
+
+	auto write = [&](int source, int dest, int count)
+	{
+		for (int sample = 0; sample < count; ++sample)
+		{
+			SampleType sum = SampleType(0);
+
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				sum += channels[channel][source + sample];
+			}
+
+			m_scope[dest + sample] = scale * (float)sum;
+		}
+	};
+
+	write(0, start1, size1);
+	write(size1, start2, size2);
+
+	m_scopeFifo.finishedWrite(size1 + size2);
+}
+
+inline bool HarmonicsAnalysis::popLevels(Levels& levels)
+{
+	int start1, size1, start2, size2;
+	m_levelsFifo.prepareToRead(1, start1, size1, start2, size2);
+
+	if (size1 == 0)
+	{
+		return false;
+	}
+
+	levels = m_levels[start1];
+	m_levelsFifo.finishedRead(1);
+	return true;
+}
+
+inline int HarmonicsAnalysis::popScope(float* dest, int maxSamples)
+{
+	int start1, size1, start2, size2;
+	m_scopeFifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+
+	std::copy(m_scope.begin() + start1, m_scope.begin() + start1 + size1, dest);
+	std::copy(m_scope.begin() + start2, m_scope.begin() + start2 + size2, dest + size1);
+
+	m_scopeFifo.finishedRead(size1 + size2);
+	return size1 + size2;
+}
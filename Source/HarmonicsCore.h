@@ -0,0 +1,896 @@
+/*
+  ==============================================================================
+
+    HarmonicsCore.h
+    The whole Harmonics DSP without JUCE: parameter ramps, the harmonic
+    kernels, oversampling, mid/side, the envelope, the silence path and the
+    output limiter behind one process() call on plain channel pointers.
+
+    prepare() allocates everything for a sample rate, channel count and
+    block size, process() then never allocates, locks or waits. Settings are
+    plain values in the units of the plugin parameters and apply with the
+    next process(): gain, mix, volume and the DC blocker ramp, buttons and
+    engines crossfade, oversampling and the limiter restart their state and
+    may change getLatency(). Denormals are left to the caller, audio threads
+    usually run with flush-to-zero anyway.
+
+    While a ramp runs, the parameters step on a grid of SUB_BLOCK_SIZE host
+    samples counted from prepare(), so the output does not depend on how
+    the audio is split into process() calls. Steady settings go through in
+    one piece. Automation with sample positions goes to the overload taking
+    HarmonicsSettingsChange, it splits the call at every change.
+
+    Stages fixes the harmonic set at compile time. HarmonicsMask::runtime
+    follows the buttons and the engine of the settings and compiles every
+    kernel variant, a mask of h2..h8 or HarmonicsMask::chebyshev ignores
+    them and compiles only the variants of that set.
+
+    The plugin processes through this class, so for the same settings the
+    output is bit-identical to the plugin's.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "FastMath.h"
+#include "HarmonicsKernel.h"
+#include "LookaheadLimiter.h"
+#include "Oversampler.h"
+#include "ParameterSmoother.h"
+
+//==============================================================================
+// Every value the DSP reads, defaults are the plugin defaults
+struct HarmonicsSettings
+{
+	HarmonicsSettings() { levels.level[2] = 1.0f; };
+
+	float gain = 0.0f;				// dB
+	float mix = 1.0f;
+	float volume = 0.0f;			// dB
+	float cutoff = 20.0f;			// Hz
+	float Q = 0.7f;
+
+	bool button2 = true;
+	bool button4 = false;
+	bool button6 = false;
+	bool button8 = false;
+
+	int oversampling = 0;			// Factor log2
+	bool chebyshev = false;
+	ChebyshevLevels levels;
+
+	bool limiter = false;
+	float lookahead = 0.001f;		// Seconds
+
+	bool midSide = false;
+	float sideGain = 0.0f;			// dB
+	float sideMix = 1.0f;
+	bool sideButton2 = true;
+	bool sideButton4 = false;
+	bool sideButton6 = false;
+	bool sideButton8 = false;
+
+	// The envelope follows the key given to process() instead of the input
+	bool envelope = false;
+	bool sidechain = false;
+	float depth = 1.0f;
+	float attack = 5.0f;			// ms
+	float release = 150.0f;			// ms
+};
+
+// Settings taking effect at a sample of the next process() call
+struct HarmonicsSettingsChange
+{
+	int sample = 0;
+	HarmonicsSettings settings;
+};
+
+//==============================================================================
+// Kernel entry and button override for a stage set
+template <int Stages>
+struct HarmonicsStageSet
+{
+	static_assert((Stages >= 0 && Stages <= HarmonicsMask::all) || Stages == HarmonicsMask::chebyshev, "Stages must be a button mask, chebyshev or runtime");
+
+	static void apply(HarmonicsParams& params)
+	{
+		params.chebyshev = Stages == HarmonicsMask::chebyshev;
+
+		params.button2 = params.sideButton2 = (Stages & HarmonicsMask::h2) != 0;
+		params.button4 = params.sideButton4 = (Stages & HarmonicsMask::h4) != 0;
+		params.button6 = params.sideButton6 = (Stages & HarmonicsMask::h6) != 0;
+		params.button8 = params.sideButton8 = (Stages & HarmonicsMask::h8) != 0;
+	};
+
+	template <typename Kernel, typename Sample>
+	static void process(Kernel& kernel, Sample* const* channels, int numChannels, int samples, const HarmonicsParams& params, HarmonicsMeter* meter)
+	{
+		kernel.template processStages<Stages>(channels, numChannels, samples, params, meter);
+	};
+};
+
+template <>
+struct HarmonicsStageSet<HarmonicsMask::runtime>
+{
+	static void apply(HarmonicsParams&) {};
+
+	template <typename Kernel, typename Sample>
+	static void process(Kernel& kernel, Sample* const* channels, int numChannels, int samples, const HarmonicsParams& params, HarmonicsMeter* meter)
+	{
+		kernel.process(channels, numChannels, samples, params, meter);
+	};
+};
+
+//==============================================================================
+template <typename SampleType, int Stages = HarmonicsMask::runtime>
+class HarmonicsCore
+{
+public:
+	using Vec = typename SIMDVectorFor<SampleType>::Type;
+
+	// Any layout up to this many channels, 7.1.4 and 7th order ambisonics fit
+	static const int MAX_CHANNELS = 64;
+	static constexpr float SMOOTHING_TIME = 0.02f;
+
+	// Filter state below this counts as decayed, silent input then skips processing
+	static constexpr float SILENCE_THRESHOLD = 1.0e-8f;
+
+	// Output limiter. Below the ceiling is headroom for the 4x true-peak detector
+	// up to 20 kHz, the clip only catches runaway harmonics while the limiter is on
+	static constexpr float LIMITER_CEILING_DB = -0.3f;
+	static constexpr float LIMITER_RELEASE_TIME = 0.05f;
+	static constexpr float LIMITER_CLIP_LEVEL = 4.0f;
+	static constexpr float MAX_LOOKAHEAD = 0.005f;
+
+	// Host rate samples between parameter steps while a ramp runs
+	static const int SUB_BLOCK_SIZE = 32;
+
+	// Allocates for up to numChannels channels of maxBlockSize host rate samples per call
+	void prepare(double sampleRate, int numChannels, int maxBlockSize, float maxLookahead = MAX_LOOKAHEAD);
+	void release();
+
+	// From the processing thread, between process() calls
+	void setSettings(const HarmonicsSettings& settings);
+	const HarmonicsSettings& getSettings() const { return m_settings; };
+
+	// Host rate samples
+	int getLatency() const { return m_latency; };
+
+	// Latency the settings will have once applied, callable from any thread after prepare()
+	int getLatency(const HarmonicsSettings& settings) const;
+
+	int getNumChannels() const { return m_numChannels; };
+	int getNumGroups() const { return (int)m_kernels.size(); };
+
+	// In place, channels past the prepared count are left as they are
+	void process(SampleType* const* channels, int numChannels, int numSamples);
+
+	// Same with the changes applied at their samples, they are sorted by sample
+	void process(SampleType* const* channels, int numChannels, int numSamples, const HarmonicsSettingsChange* changes, int numChanges);
+
+	// Sidechain is null or holds a host rate channel per channel, it is only read.
+	// Levels are added to meter when it is not null. runGroups(numGroups,
+	// kernelSamples, processGroup) may run processGroup(group) for every group on other threads
+	// and returns true once all are done, or false to have them run here in order.
+	// Returns false for silent output without writing it, the caller clears the channels
+	template <typename GroupRunner>
+	bool process(SampleType* const* channels, const SampleType* const* sidechain, int numChannels, int numSamples, HarmonicsMeter* meter, bool inputSilent, GroupRunner& runGroups);
+
+	static bool isSilent(const SampleType* const* channels, int numChannels, int numSamples);
+
+protected:
+	static float decibelsToGain(float decibels) { return decibels > -100.0f ? HarmonicsMath::decibelsToGain(decibels) : 0.0f; };
+
+	// Kernel samples with one parameter set, planned once for all groups
+	struct SubBlock
+	{
+		int start = 0;
+		int samples = 0;
+		HarmonicsParams params;
+		HarmonicsParams sideParams;
+		bool highPassChanged = false;
+		SecondOrderHighPassCoefs<SampleType> highPass;
+	};
+
+	// For kernels with a single lane, source and destination may be the same channels
+	static void encodeMidSide(const SampleType* const* source, SampleType* const* destination, int samples);
+	static void decodeMidSide(SampleType* const* channels, int samples);
+
+	// Host rate output into one of the limiter levels, weighted to count like the kernel samples
+	void measureOutput(const SampleType* const* channels, int numChannels, int samples, HarmonicsMeter::Level level, HarmonicsMeter& meter) const;
+
+	template <typename GroupRunner>
+	void processKernel(SampleType* const* channels, const SampleType* const* sidechain, int numChannels, int samples, const HarmonicsParams& params, HarmonicsMeter* meter, GroupRunner& runGroups);
+
+	HarmonicsParams getParams(int numChannels) const;
+	void setOversampling(int factorLog2);
+	void setLimiter(bool enabled, int lookahead);
+	void setEnvelopeTimes(float attackMs, float releaseMs);
+	void resetSmoothers();
+	void updateLatency();
+	bool isRamping() const;
+	bool isDecayed() const;
+	void settle(const HarmonicsParams& params);
+
+	HarmonicsSettings m_settings;
+
+	// One kernel per group of lanes, filter state is stored channels innermost
+	std::vector<HarmonicsKernel<Vec>> m_kernels;
+	Oversampler<SampleType> m_oversampler;
+
+	// DC blocker coefficients for all kernels, recomputed only when cutoff or Q move
+	SecondOrderHighPassCache<SampleType> m_highPassCache;
+
+	LookaheadLimiter<SampleType> m_limiter;
+
+	// Mid/side key of the single lane kernels, two host rate channels of maxBlockSize
+	std::vector<SampleType> m_keyScratch;
+
+	// Room for the sub-blocks of one chunk, position on the grid in host samples
+	std::vector<SubBlock> m_subBlocks;
+	int m_gridPosition = 0;
+
+	// Cutoff or Q moved since the DC blocker was last updated, it updates on the next grid point
+	bool m_highPassPending = false;
+
+	// The last sub-block ramped and ended off the grid, the kernels carry its ramps on
+	bool m_rampsContinue = false;
+
+	int m_sampleRate = 0;
+	int m_numChannels = 0;
+	int m_maxBlockSize = 0;
+	int m_maxLookahead = 0;
+	int m_factorLog2 = 0;
+
+	bool m_limiterEnabled = false;
+	int m_lookahead = 0;
+	int m_limiterLatency = 0;
+	int m_latency = 0;
+	bool m_midSide = false;
+
+	// Envelope one-pole coefficients per kernel sample, recomputed when the times or the rate change
+	float m_attackTime = 0.0f;
+	float m_releaseTime = 0.0f;
+	float m_attackCoef = 1.0f;
+	float m_releaseCoef = 1.0f;
+
+	ParameterSmoother m_gainSmoother;
+	ParameterSmoother m_mixSmoother;
+	ParameterSmoother m_volumeSmoother;
+	ParameterSmoother m_cutoffSmoother;
+	ParameterSmoother m_qSmoother;
+	ParameterSmoother m_sideGainSmoother;
+	ParameterSmoother m_sideMixSmoother;
+
+	// Silence fast-path
+	int m_silentSamples = 0;
+	int m_silenceFlushSamples = 0;
+	bool m_isSilent = false;
+};
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::prepare(double sampleRate, int numChannels, int maxBlockSize, float maxLookahead)
+{
+	m_sampleRate = (int)sampleRate;
+	m_numChannels = std::max(0, std::min(numChannels, (int)MAX_CHANNELS));
+	m_maxBlockSize = maxBlockSize;
+	m_maxLookahead = (int)std::ceil(maxLookahead * sampleRate);
+
+	m_kernels.resize((m_numChannels + Vec::size - 1) / Vec::size);
+	m_oversampler.init(m_numChannels, maxBlockSize);
+	m_limiter.prepare(m_numChannels, sampleRate, m_maxLookahead);
+
+	m_subBlocks.resize((size_t)(maxBlockSize / SUB_BLOCK_SIZE + 2));
+	m_keyScratch.assign((size_t)(2 * maxBlockSize), SampleType(0));
+	m_gridPosition = 0;
+	m_highPassPending = false;
+	m_rampsContinue = false;
+
+	// Everything below restarts from the current settings
+	setOversampling(m_settings.oversampling);
+	setLimiter(m_settings.limiter, (int)std::nearbyint(m_settings.lookahead * static_cast<float>(m_sampleRate)));
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::release()
+{
+	std::vector<HarmonicsKernel<Vec>>().swap(m_kernels);
+	m_oversampler.release();
+	m_limiter.release();
+	std::vector<SubBlock>().swap(m_subBlocks);
+	std::vector<SampleType>().swap(m_keyScratch);
+
+	m_numChannels = 0;
+	m_maxBlockSize = 0;
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::setSettings(const HarmonicsSettings& settings)
+{
+	m_settings = settings;
+
+	if (m_maxBlockSize == 0)
+	{
+		return;
+	}
+
+	// Oversampling, buffers are preallocated so switching only resets state
+	if (settings.oversampling != m_factorLog2)
+	{
+		setOversampling(settings.oversampling);
+	}
+
+	// Limiter, switching it or the lookahead restarts its delay line and changes the latency
+	const int lookahead = std::max(0, std::min((int)std::nearbyint(settings.lookahead * static_cast<float>(m_sampleRate)), m_maxLookahead));
+
+	if (settings.limiter != m_limiterEnabled || lookahead != m_lookahead)
+	{
+		setLimiter(settings.limiter, lookahead);
+	}
+
+	setEnvelopeTimes(settings.attack, settings.release);
+
+	// The smoothers ramp towards them inside the kernel
+	m_gainSmoother.setTarget(decibelsToGain(settings.gain));
+	m_mixSmoother.setTarget(settings.mix);
+	m_volumeSmoother.setTarget(decibelsToGain(settings.volume));
+	m_cutoffSmoother.setTarget(settings.cutoff);
+	m_qSmoother.setTarget(settings.Q);
+	m_sideGainSmoother.setTarget(decibelsToGain(settings.sideGain));
+	m_sideMixSmoother.setTarget(settings.sideMix);
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::setOversampling(int factorLog2)
+{
+	m_oversampler.setFactorLog2(factorLog2);
+	m_factorLog2 = m_oversampler.getFactorLog2();
+
+	// Nonlinear core runs at the oversampled rate
+	const int sampleRate = m_sampleRate << m_factorLog2;
+
+	// Envelope coefficients count kernel samples too
+	m_attackTime = 0.0f;
+	m_releaseTime = 0.0f;
+	setEnvelopeTimes(m_settings.attack, m_settings.release);
+
+	// A fixed stage set starts settled, it never fades
+	for (auto& kernel : m_kernels)
+	{
+		kernel.init(sampleRate);
+
+		if (Stages == HarmonicsMask::runtime)
+		{
+			kernel.reset();
+		}
+		else
+		{
+			kernel.settle(getParams(m_numChannels));
+		}
+	}
+
+	// Kernels get their highpass coefficients with the next block
+	m_highPassCache.clear();
+
+	// Ramps count kernel samples
+	const int rampSamples = (int)(SMOOTHING_TIME * static_cast<float>(sampleRate));
+
+	m_gainSmoother.init(ParameterSmoother::Type::Multiplicative, rampSamples);
+	m_mixSmoother.init(ParameterSmoother::Type::Linear, rampSamples);
+	m_volumeSmoother.init(ParameterSmoother::Type::Multiplicative, rampSamples);
+	m_cutoffSmoother.init(ParameterSmoother::Type::Multiplicative, rampSamples);
+	m_qSmoother.init(ParameterSmoother::Type::Linear, rampSamples);
+	m_sideGainSmoother.init(ParameterSmoother::Type::Multiplicative, rampSamples);
+	m_sideMixSmoother.init(ParameterSmoother::Type::Linear, rampSamples);
+
+	resetSmoothers();
+	updateLatency();
+	m_rampsContinue = false;
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::setLimiter(bool enabled, int lookahead)
+{
+	m_limiterEnabled = enabled;
+	m_lookahead = std::max(0, std::min(lookahead, m_maxLookahead));
+
+	m_limiter.setLookahead(m_lookahead);
+	m_limiter.setCeiling((SampleType)decibelsToGain(LIMITER_CEILING_DB));
+	m_limiter.setReleaseTime(LIMITER_RELEASE_TIME);
+
+	m_limiterLatency = m_limiterEnabled ? m_lookahead + LookaheadLimiter<SampleType>::DETECTOR_DELAY : 0;
+	updateLatency();
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::setEnvelopeTimes(float attackMs, float releaseMs)
+{
+	if (attackMs == m_attackTime && releaseMs == m_releaseTime)
+	{
+		return;
+	}
+
+	m_attackTime = attackMs;
+	m_releaseTime = releaseMs;
+
+	// The kernel needs the attack at least as fast as the release. The envelope steps once per interval
+	const double intervalRate = (double)(m_sampleRate << m_factorLog2) / HarmonicsKernel<Vec>::envelopeInterval;
+	auto coefficient = [intervalRate](float ms) { return (float)(1.0 - std::exp(-1.0 / std::max(1.0, 0.001 * ms * intervalRate))); };
+
+	m_attackCoef = coefficient(std::min(attackMs, releaseMs));
+	m_releaseCoef = coefficient(releaseMs);
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::resetSmoothers()
+{
+	m_gainSmoother.reset(decibelsToGain(m_settings.gain));
+	m_mixSmoother.reset(m_settings.mix);
+	m_volumeSmoother.reset(decibelsToGain(m_settings.volume));
+	m_cutoffSmoother.reset(m_settings.cutoff);
+	m_qSmoother.reset(m_settings.Q);
+	m_sideGainSmoother.reset(decibelsToGain(m_settings.sideGain));
+	m_sideMixSmoother.reset(m_settings.sideMix);
+}
+
+template <typename SampleType, int Stages>
+inline int HarmonicsCore<SampleType, Stages>::getLatency(const HarmonicsSettings& settings) const
+{
+	const int lookahead = std::max(0, std::min((int)std::nearbyint(settings.lookahead * (float)m_sampleRate), m_maxLookahead));
+	const int limiterLatency = settings.limiter ? lookahead + LookaheadLimiter<SampleType>::DETECTOR_DELAY : 0;
+
+	return (int)std::nearbyint(m_oversampler.getLatency(settings.oversampling)) + limiterLatency;
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::updateLatency()
+{
+	// Ties round to even, 4x reports 38 samples
+	const float latency = m_oversampler.getLatency();
+	m_latency = (int)std::nearbyint(latency) + m_limiterLatency;
+
+	// Silent input has flushed the oversampling filters after twice their latency,
+	// the limiter once its delay line has passed
+	m_silenceFlushSamples = (int)std::ceil(2.0f * latency) + m_limiterLatency;
+	m_silentSamples = 0;
+	m_isSilent = false;
+}
+
+template <typename SampleType, int Stages>
+inline HarmonicsParams HarmonicsCore<SampleType, Stages>::getParams(int numChannels) const
+{
+	const auto& settings = m_settings;
+
+	HarmonicsParams params;
+	params.button2 = settings.button2;
+	params.button4 = settings.button4;
+	params.button6 = settings.button6;
+	params.button8 = settings.button8;
+	params.clipLevel = m_limiterEnabled ? LIMITER_CLIP_LEVEL : 1.0f;
+
+	// Chebyshev levels, the kernel only recomputes its table when they change
+	params.chebyshev = settings.chebyshev;
+	params.levels = settings.levels;
+
+	// Mid/side, only on a stereo pair
+	params.midSide = settings.midSide && numChannels == 2;
+	params.sideButton2 = settings.sideButton2;
+	params.sideButton4 = settings.sideButton4;
+	params.sideButton6 = settings.sideButton6;
+	params.sideButton8 = settings.sideButton8;
+
+	// Envelope, depth applies right away like the buttons
+	params.envelope = settings.envelope;
+	params.envelopeDepth = settings.depth;
+	params.envelopeAttack = m_attackCoef;
+	params.envelopeRelease = m_releaseCoef;
+
+	HarmonicsStageSet<Stages>::apply(params);
+	return params;
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::process(SampleType* const* channels, int numChannels, int numSamples)
+{
+	auto runHere = [](int, int, auto&) { return false; };
+
+	numChannels = std::min(numChannels, m_numChannels);
+
+	if (! process(channels, nullptr, numChannels, numSamples, nullptr, isSilent(channels, numChannels, numSamples), runHere))
+	{
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			std::fill(channels[channel], channels[channel] + numSamples, SampleType(0));
+		}
+	}
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::process(SampleType* const* channels, int numChannels, int numSamples, const HarmonicsSettingsChange* changes, int numChanges)
+{
+	numChannels = std::min(numChannels, m_numChannels);
+
+	SampleType* segment[MAX_CHANNELS];
+	int position = 0;
+
+	for (int index = 0; index <= numChanges; ++index)
+	{
+		const int end = index < numChanges ? std::max(position, std::min(changes[index].sample, numSamples)) : numSamples;
+
+		if (end > position)
+		{
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				segment[channel] = channels[channel] + position;
+			}
+
+			process(segment, numChannels, end - position);
+			position = end;
+		}
+
+		if (index < numChanges)
+		{
+			setSettings(changes[index].settings);
+		}
+	}
+}
+
+template <typename SampleType, int Stages>
+template <typename GroupRunner>
+inline bool HarmonicsCore<SampleType, Stages>::process(SampleType* const* channels, const SampleType* const* sidechain, int numChannels, int numSamples, HarmonicsMeter* meter, bool inputSilent, GroupRunner& runGroups)
+{
+	numChannels = std::min(numChannels, m_numChannels);
+
+	const HarmonicsParams params = getParams(numChannels);
+
+	// The filters hold the other encoding, switching restarts them
+	if (params.midSide != m_midSide)
+	{
+		m_midSide = params.midSide;
+
+		for (auto& kernel : m_kernels)
+		{
+			kernel.reset();
+		}
+	}
+
+	// Silence: once the input has been silent long enough and the filters have decayed, output is silent too
+	const bool flushed = m_silentSamples >= m_silenceFlushSamples;
+
+	if (! inputSilent)
+	{
+		m_silentSamples = 0;
+		m_isSilent = false;
+	}
+	else if (! flushed)
+	{
+		m_silentSamples += numSamples;
+	}
+
+	if (inputSilent && flushed && (m_isSilent || isDecayed()))
+	{
+		settle(params);
+		m_gridPosition = (m_gridPosition + numSamples) % SUB_BLOCK_SIZE;
+
+		// Skipped kernel samples still count, the levels average over the silence
+		if (meter != nullptr)
+		{
+			meter->samples += (numSamples << m_factorLog2) * numChannels;
+		}
+
+		return false;
+	}
+
+	// The key only drives the envelope
+	const SampleType* const* key = m_settings.envelope && m_settings.sidechain ? sidechain : nullptr;
+
+	// Callers may send more than maxBlockSize, process in chunks that fit the buffers and the sub-block plan
+	for (int offset = 0; offset < numSamples; offset += m_maxBlockSize)
+	{
+		const int chunk = std::min(m_maxBlockSize, numSamples - offset);
+
+		SampleType* channelChunk[MAX_CHANNELS];
+		const SampleType* keyChunk[MAX_CHANNELS];
+
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			channelChunk[channel] = channels[channel] + offset;
+			keyChunk[channel] = key != nullptr ? key[channel] + offset : nullptr;
+		}
+
+		if (m_factorLog2 == 0)
+		{
+			processKernel(channelChunk, key != nullptr ? keyChunk : nullptr, numChannels, chunk, params, meter, runGroups);
+		}
+		else
+		{
+			auto* const* oversampled = m_oversampler.upsample(channelChunk, numChannels, chunk);
+			processKernel(oversampled, key != nullptr ? keyChunk : nullptr, numChannels, chunk << m_factorLog2, params, meter, runGroups);
+			m_oversampler.downsample(channelChunk, numChannels, chunk);
+		}
+	}
+
+	if (meter != nullptr)
+	{
+		measureOutput(channels, numChannels, numSamples, HarmonicsMeter::preLimiter, *meter);
+	}
+
+	if (m_limiterEnabled)
+	{
+		m_limiter.process(channels, numChannels, numSamples);
+	}
+
+	if (meter != nullptr)
+	{
+		measureOutput(channels, numChannels, numSamples, HarmonicsMeter::postLimiter, *meter);
+	}
+
+	return true;
+}
+
+template <typename SampleType, int Stages>
+template <typename GroupRunner>
+inline void HarmonicsCore<SampleType, Stages>::processKernel(SampleType* const* channels, const SampleType* const* sidechain, int numChannels, int samples, const HarmonicsParams& buttonParams, HarmonicsMeter* meter, GroupRunner& runGroups)
+{
+	// Single lane kernels cannot hold the mid/side pair. The pair is encoded in place instead,
+	// the first kernel gets mid and the second side with its own settings
+	const bool splitMidSide = buttonParams.midSide && Vec::size == 1;
+	const auto kernelRate = (SampleType)(m_sampleRate << m_factorLog2);
+
+	// Sub-blocks end on the grid while anything ramps, so the steps fall on the same samples
+	// however the host splits the audio. Steady parameters take the whole chunk
+	int numSubBlocks = 0;
+
+	for (int start = 0; start < samples; )
+	{
+		auto& block = m_subBlocks[(size_t)numSubBlocks++];
+		const bool stepping = isRamping() || m_highPassPending;
+
+		// DC blocker follows cutoff and Q from the start of every grid cell, the kernels share one coefficient set
+		block.highPassChanged = false;
+
+		if (! stepping || m_gridPosition == 0 || ! m_highPassCache.isValid())
+		{
+			block.highPassChanged = m_highPassCache.update(kernelRate, (SampleType)m_cutoffSmoother.getCurrent(), (SampleType)m_qSmoother.getCurrent());
+			m_highPassPending = false;
+
+			if (block.highPassChanged)
+			{
+				block.highPass = m_highPassCache.getCoefs();
+			}
+		}
+
+		const int length = stepping ? std::min(samples - start, (SUB_BLOCK_SIZE - m_gridPosition) << m_factorLog2) : samples - start;
+		block.start = start;
+		block.samples = length;
+
+		// Parameter ramps, the kernel only takes the ramped path while they run. Within a grid cell
+		// the kernels go on from where they are, on the grid they restart from the smoothers
+		auto& params = block.params;
+		params = buttonParams;
+		params.rampContinues = stepping && m_rampsContinue && m_gridPosition != 0;
+
+		const auto gainRamp = m_gainSmoother.advance(length);
+		params.gain = gainRamp.start;
+		params.gainRatio = gainRamp.step;
+		params.gainRampSamples = gainRamp.samples;
+
+		const auto mixRamp = m_mixSmoother.advance(length);
+		params.mix = mixRamp.start;
+		params.mixStep = mixRamp.step;
+		params.mixRampSamples = mixRamp.samples;
+
+		const auto volumeRamp = m_volumeSmoother.advance(length);
+		params.volume = volumeRamp.start;
+		params.volumeRatio = volumeRamp.step;
+		params.volumeRampSamples = volumeRamp.samples;
+
+		const auto sideGainRamp = m_sideGainSmoother.advance(length);
+		params.sideGain = sideGainRamp.start;
+		params.sideGainRatio = sideGainRamp.step;
+		params.sideGainRampSamples = sideGainRamp.samples;
+
+		const auto sideMixRamp = m_sideMixSmoother.advance(length);
+		params.sideMix = sideMixRamp.start;
+		params.sideMixStep = sideMixRamp.step;
+		params.sideMixRampSamples = sideMixRamp.samples;
+
+		if (splitMidSide)
+		{
+			block.sideParams = params.forSide();
+			params.midSide = false;
+		}
+
+		const bool cutoffMoved = m_cutoffSmoother.advance(length).samples > 0;
+		const bool qMoved = m_qSmoother.advance(length).samples > 0;
+		m_highPassPending = m_highPassPending || cutoffMoved || qMoved;
+
+		m_gridPosition = (m_gridPosition + (length >> m_factorLog2)) % SUB_BLOCK_SIZE;
+		m_rampsContinue = stepping && m_gridPosition != 0;
+		start += length;
+	}
+
+	// Kernel variant is picked from the buttons, disabled stages are not computed.
+	// Channels go through the kernels in groups of Vec::size lanes
+	const int numGroups = (numChannels + Vec::size - 1) / Vec::size;
+
+	// Groups share no state, each meters into its own levels, summed in group order below
+	// so the levels do not depend on which thread ran what
+	HarmonicsMeter groupMeters[MAX_CHANNELS];
+
+	// The host's key is only read, a stereo one is encoded into the scratch. A mono key stays as it is for both
+	SampleType* keyScratch[2] = { m_keyScratch.data(), m_keyScratch.data() + m_maxBlockSize };
+
+	if (splitMidSide)
+	{
+		encodeMidSide(channels, channels, samples);
+
+		if (sidechain != nullptr && sidechain[0] != sidechain[1])
+		{
+			encodeMidSide(sidechain, keyScratch, samples >> m_factorLog2);
+			sidechain = keyScratch;
+		}
+	}
+
+	auto processGroup = [&](int group)
+	{
+		const int first = group * Vec::size;
+		const int groupChannels = std::min((int)Vec::size, numChannels - first);
+		auto& kernel = m_kernels[group];
+		HarmonicsMeter* groupMeter = meter != nullptr ? &groupMeters[group] : nullptr;
+
+		SampleType* blockChannels[Vec::size];
+		const SampleType* blockKeys[Vec::size];
+
+		for (int index = 0; index < numSubBlocks; ++index)
+		{
+			const auto& block = m_subBlocks[(size_t)index];
+
+			if (block.highPassChanged)
+			{
+				kernel.setHighPass(block.highPass);
+			}
+
+			// Sub-blocks start on whole host samples, the key is at the host rate
+			for (int channel = 0; channel < groupChannels; ++channel)
+			{
+				blockChannels[channel] = channels[first + channel] + block.start;
+				blockKeys[channel] = sidechain != nullptr ? sidechain[first + channel] + (block.start >> m_factorLog2) : nullptr;
+			}
+
+			kernel.setSidechain(sidechain != nullptr ? blockKeys : nullptr, m_factorLog2);
+			HarmonicsStageSet<Stages>::process(kernel, blockChannels, groupChannels, block.samples, splitMidSide && group == 1 ? block.sideParams : block.params, groupMeter);
+		}
+	};
+
+	if (! runGroups(numGroups, samples, processGroup))
+	{
+		for (int group = 0; group < numGroups; ++group)
+		{
+			processGroup(group);
+		}
+	}
+
+	if (splitMidSide)
+	{
+		decodeMidSide(channels, samples);
+	}
+
+	if (meter != nullptr)
+	{
+		for (int group = 0; group < numGroups; ++group)
+		{
+			meter->add(groupMeters[group]);
+		}
+	}
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::encodeMidSide(const SampleType* const* source, SampleType* const* destination, int samples)
+{
+	for (int sample = 0; sample < samples; ++sample)
+	{
+		const SampleType left = source[0][sample];
+		const SampleType right = source[1][sample];
+
+		destination[0][sample] = SampleType(0.5) * (left + right);
+		destination[1][sample] = SampleType(0.5) * (left - right);
+	}
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::decodeMidSide(SampleType* const* channels, int samples)
+{
+	for (int sample = 0; sample < samples; ++sample)
+	{
+		const SampleType mid = channels[0][sample];
+		const SampleType side = channels[1][sample];
+
+		channels[0][sample] = mid + side;
+		channels[1][sample] = mid - side;
+	}
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::measureOutput(const SampleType* const* channels, int numChannels, int samples, HarmonicsMeter::Level level, HarmonicsMeter& meter) const
+{
+	SampleType sumSquares = 0;
+	SampleType peak = 0;
+
+	for (int channel = 0; channel < numChannels; ++channel)
+	{
+		for (int sample = 0; sample < samples; ++sample)
+		{
+			const SampleType value = channels[channel][sample];
+			sumSquares += value * value;
+			peak = std::max(peak, std::abs(value));
+		}
+	}
+
+	meter.sumSquares[level] += (float)(sumSquares * SampleType(1 << m_factorLog2));
+	meter.peak[level] = std::max(meter.peak[level], (float)peak);
+}
+
+template <typename SampleType, int Stages>
+inline bool HarmonicsCore<SampleType, Stages>::isSilent(const SampleType* const* channels, int numChannels, int numSamples)
+{
+	for (int channel = 0; channel < numChannels; ++channel)
+	{
+		for (int sample = 0; sample < numSamples; ++sample)
+		{
+			if (channels[channel][sample] != SampleType(0))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+template <typename SampleType, int Stages>
+inline bool HarmonicsCore<SampleType, Stages>::isRamping() const
+{
+	return m_gainSmoother.isSmoothing() || m_mixSmoother.isSmoothing() || m_volumeSmoother.isSmoothing() || m_cutoffSmoother.isSmoothing()
+		|| m_qSmoother.isSmoothing() || m_sideGainSmoother.isSmoothing() || m_sideMixSmoother.isSmoothing();
+}
+
+template <typename SampleType, int Stages>
+inline bool HarmonicsCore<SampleType, Stages>::isDecayed() const
+{
+	for (const auto& kernel : m_kernels)
+	{
+		if (! kernel.isDecayed(SILENCE_THRESHOLD))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template <typename SampleType, int Stages>
+inline void HarmonicsCore<SampleType, Stages>::settle(const HarmonicsParams& params)
+{
+	// Nothing is audible, so ramps and fades jump to their targets
+	resetSmoothers();
+	m_rampsContinue = false;
+
+	for (auto& kernel : m_kernels)
+	{
+		kernel.settle(params);
+	}
+
+	// Oversampling history only once per silent stretch, it is the expensive part
+	if (! m_isSilent)
+	{
+		m_oversampler.reset();
+		m_limiter.reset();
+		m_isSilent = true;
+	}
+}
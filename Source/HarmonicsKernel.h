@@ -0,0 +1,1048 @@
+/*
+  ==============================================================================
+
+    HarmonicsKernel.h
+    Harmonic chain with one channel per SIMD lane. The sample type follows the
+    vector, FloatVec4/FloatVec1 for float and DoubleVec2/DoubleVec1 for double.
+
+    The chain is specialised per harmonic button combination: processBlock
+    picks one of the 16 variants once per block and each variant only runs
+    the filter stages its enabled harmonics depend on. Toggling a harmonic
+    crossfades it over a few milliseconds, the union of the old and new
+    stages runs until the fade is done.
+    processStages() takes a set fixed at compile time instead and only
+    instantiates the variants of that set.
+
+    Every variant also exists in a dynamic version that updates the toggle
+    weights and the gain/mix/volume ramps per sample. It is only used while
+    something is actually moving. Metered versions additionally collect the
+    harmonic and limiter levels for the editor, they only run while it is open
+    or an offline tool asks for the levels.
+
+    The Chebyshev engine is one more variant next to the 16 button masks. It
+    replaces the squaring chain with ChebyshevShaper and a single DC blocker,
+    level changes ramp the coefficient table. Switching engines first fades
+    the old one out, then the new one in from silence.
+
+    Mid/side variants take a stereo pair, encode it into mid and side lanes
+    while loading and decode it while storing, in the same pass. Gain, mix
+    and the harmonic buttons are per lane there, the side lane follows its
+    own settings. The Chebyshev levels, volume and DC blocker are shared.
+
+    Enveloped variants follow the input, or a sidechain, with a one-pole
+    attack/release envelope per lane. The drive into the harmonic chain is
+    scaled towards what brings the envelope to envelopeReference and the
+    harmonics are scaled back by the inverse, so the harmonic to dry ratio
+    stays about the same at any level. The Chebyshev engine scales its sum,
+    harmonic k moves with the (k - 1)th power of the drive. The squaring
+    chain folds the makeup into the second harmonic gain, so there harmonic
+    k moves with the (k / 2)th power. Per sample the follower only takes the
+    peak of the detector, a sidechain is peaked up front. Every
+    envelopeInterval samples that peak steps the envelope and new drive and
+    makeup targets are worked out from it. The ramps head for the targets of
+    the step before, so the divisions run alongside the samples and the
+    follower stays out of the per sample cost.
+
+    With all fades and ramps settled the kernel does the same operations in the same
+    order as the original scalar loop (no FMA, no reassociation), so the
+    output is bit-identical to it. The only exception is a build where the
+    compiler contracts multiply-adds into FMA (-ffp-contract=fast with FMA
+    enabled, /fp:contract); the output then differs by at most a few ulp
+    per filter stage, or one built with another HARMONICS_HIGHPASS_TOPOLOGY.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "SIMDVector.h"
+#include "SecondOrderHighPassSIMD.h"
+#include "ChebyshevShaper.h"
+
+//==============================================================================
+struct HarmonicsParams
+{
+	float gain = 1.0f;
+	float mix = 1.0f;
+	float volume = 1.0f;
+
+	bool button2 = true;
+	bool button4 = false;
+	bool button6 = false;
+	bool button8 = false;
+
+	// Hard clip of the harmonic signal, raised above 1 when the lookahead limiter follows
+	float clipLevel = 1.0f;
+
+	// Chebyshev engine replaces the buttons with per harmonic levels
+	bool chebyshev = false;
+	ChebyshevLevels levels;
+
+	// Mid/side, the settings above are for mid, these for side
+	bool midSide = false;
+	float sideGain = 1.0f;
+	float sideMix = 1.0f;
+
+	bool sideButton2 = true;
+	bool sideButton4 = false;
+	bool sideButton6 = false;
+	bool sideButton8 = false;
+
+	// Per sample ramps, each one runs for the first ...RampSamples of the block
+	float gainRatio = 1.0f;
+	float mixStep = 0.0f;
+	float volumeRatio = 1.0f;
+
+	int gainRampSamples = 0;
+	int mixRampSamples = 0;
+	int volumeRampSamples = 0;
+
+	float sideGainRatio = 1.0f;
+	float sideMixStep = 0.0f;
+
+	int sideGainRampSamples = 0;
+	int sideMixRampSamples = 0;
+
+	// Ramps go on from the values the previous call ended with instead of the ones above,
+	// so a ramp split over calls accumulates the same as in one call
+	bool rampContinues = false;
+
+	// Envelope driven drive, 0 depth is the fixed drive. One-pole coefficients per envelopeInterval
+	// kernel samples, attack has to be at least release
+	bool envelope = false;
+	float envelopeDepth = 1.0f;
+	float envelopeAttack = 1.0f;
+	float envelopeRelease = 1.0f;
+
+	bool isRamping() const
+	{
+		return rampContinues || gainRampSamples > 0 || mixRampSamples > 0 || volumeRampSamples > 0
+			|| (midSide && (sideGainRampSamples > 0 || sideMixRampSamples > 0));
+	};
+
+	// The same block past its first samples, the ramps go on from where those ended
+	HarmonicsParams skip(int samples) const
+	{
+		HarmonicsParams rest = *this;
+		rest.rampContinues = true;
+
+		rest.gainRampSamples = std::max(0, gainRampSamples - samples);
+		rest.mixRampSamples = std::max(0, mixRampSamples - samples);
+		rest.volumeRampSamples = std::max(0, volumeRampSamples - samples);
+		rest.sideGainRampSamples = std::max(0, sideGainRampSamples - samples);
+		rest.sideMixRampSamples = std::max(0, sideMixRampSamples - samples);
+
+		return rest;
+	}
+
+	// Side settings in place of the mid ones, for a kernel that only gets the side signal
+	HarmonicsParams forSide() const
+	{
+		HarmonicsParams side = *this;
+		side.midSide = false;
+
+		side.gain = sideGain;
+		side.mix = sideMix;
+		side.button2 = sideButton2;
+		side.button4 = sideButton4;
+		side.button6 = sideButton6;
+		side.button8 = sideButton8;
+
+		side.gainRatio = sideGainRatio;
+		side.mixStep = sideMixStep;
+		side.gainRampSamples = sideGainRampSamples;
+		side.mixRampSamples = sideMixRampSamples;
+
+		return side;
+	}
+};
+
+//==============================================================================
+// Levels of one block, summed over the channels. The metered variants fill the harmonics
+// and the harmonic sum before and after its clip, HarmonicsCore the output around the limiter
+struct HarmonicsMeter
+{
+	enum Level
+	{
+		harmonic2,
+		harmonic4,
+		harmonic6,
+		harmonic8,
+		harmonics,
+		clippedHarmonics,
+		preLimiter,
+		postLimiter,
+		numLevels
+	};
+
+	float sumSquares[numLevels] = {};
+	float peak[numLevels] = {};
+	int samples = 0;
+
+	// Energy going into the harmonic chain and samples the harmonic clip changed, the editor shows neither
+	float driveSumSquares = 0.0f;
+	int clipped = 0;
+
+	void add(const HarmonicsMeter& other)
+	{
+		for (int level = 0; level < numLevels; ++level)
+		{
+			sumSquares[level] += other.sumSquares[level];
+			peak[level] = fmaxf(peak[level], other.peak[level]);
+		}
+
+		samples += other.samples;
+		driveSumSquares += other.driveSumSquares;
+		clipped += other.clipped;
+	}
+};
+
+//==============================================================================
+namespace HarmonicsMask
+{
+	// Harmonic bits, also used for the filter stage producing that harmonic
+	enum
+	{
+		h2 = 1 << 0,
+		h4 = 1 << 1,
+		h6 = 1 << 2,
+		h8 = 1 << 3,
+		all = h2 | h4 | h6 | h8,
+
+		// Table index of the Chebyshev engine, after the button masks
+		chebyshev = 16,
+
+		// No fixed set, the buttons and the engine pick the variant per block
+		runtime = -1
+	};
+
+	inline int fromParams(const HarmonicsParams& params)
+	{
+		return (params.button2 ? h2 : 0) | (params.button4 ? h4 : 0) | (params.button6 ? h6 : 0) | (params.button8 ? h8 : 0);
+	}
+
+	inline int fromSideParams(const HarmonicsParams& params)
+	{
+		return (params.sideButton2 ? h2 : 0) | (params.sideButton4 ? h4 : 0) | (params.sideButton6 ? h6 : 0) | (params.sideButton8 ? h8 : 0);
+	}
+
+	// Stages needed to produce a harmonic set: 4 feeds 6 and 8, 2 feeds everything
+	constexpr int stagesFor(int mask)
+	{
+		return mask == chebyshev ? 0 : (mask != 0 ? h2 : 0) | ((mask & (h4 | h6 | h8)) != 0 ? h4 : 0) | (mask & h6) | (mask & h8);
+	}
+}
+
+//==============================================================================
+template <typename Vec>
+class HarmonicsKernel
+{
+public:
+	using Sample = typename Vec::Sample;
+
+	static const int maxChannels = Vec::size;
+
+	void init(int sampleRate);
+	void reset();
+
+	// DC blocker coefficients, shared by all highpass stages
+	void setHighPass(const SecondOrderHighPassCoefs<Sample>& coefs) { m_highPassCoefs.set(coefs); };
+
+	// Envelope detector input for the next process() call, one channel per processed channel.
+	// It runs at the host rate, kernel sample n reads sidechain sample n >> shift. Null follows the input
+	void setSidechain(const Sample* const* channels, int shift) { m_sidechain = channels; m_sidechainShift = shift; };
+
+	// Levels are added to meter when it is not null. Mid/side needs numChannels == 2 and at least two lanes
+	void process(Sample* const* channels, int numChannels, int samples, const HarmonicsParams& params, HarmonicsMeter* meter = nullptr);
+
+	// Fixed harmonic set, only the variants of Mask are compiled. The kernel has to be settled
+	// with mid and side buttons set to Mask, or the Chebyshev engine, and params has to keep them
+	template <int Mask>
+	void processStages(Sample* const* channels, int numChannels, int samples, const HarmonicsParams& params, HarmonicsMeter* meter = nullptr);
+
+	// Silence handling: once the filters have decayed the chain only has its dry path left,
+	// settle() zeroes the state and jumps the toggle fades to the buttons
+	bool isDecayed(float threshold) const;
+	void settle(const HarmonicsParams& params);
+
+	// Harmonic gains
+	static constexpr float gain2 = 2.0f;
+	static constexpr float gain4 = 8.0f;
+	static constexpr float gain6 = 16.0f;
+	static constexpr float gain8 = 24.0f;
+
+	static constexpr float fadeTimeSeconds = 0.01f;
+
+	// Envelope level the drive normalises to, the largest drive boost (+24 dB), and the
+	// samples per follower step (0.7 ms at 48 kHz)
+	static constexpr float envelopeReference = 0.25f;
+	static constexpr float envelopeMaxDrive = 16.0f;
+	static constexpr int envelopeInterval = 32;
+	static_assert((envelopeInterval & (envelopeInterval - 1)) == 0, "envelopeInterval must be a power of two");
+
+protected:
+	using ProcessFn = void (HarmonicsKernel::*)(Sample* const*, int, int, const HarmonicsParams&, HarmonicsMeter*);
+
+	using ProcessTable = std::array<ProcessFn, 17>;
+
+	template <int Mask, bool Dynamic, bool Metered, bool MidSide, bool Enveloped>
+	void processMasked(Sample* const* channels, int numChannels, int samples, const HarmonicsParams& params, HarmonicsMeter* meter);
+
+	// A single lane has no room for the mid/side pair, its mid/side slots hold the plain variants and are never picked
+	static constexpr bool hasMidSide = Vec::size >= 2;
+
+	template <bool Dynamic, bool Metered, bool MidSide, bool Enveloped, size_t... Masks>
+	static constexpr ProcessTable makeTable(std::index_sequence<Masks...>)
+	{
+		return { { &HarmonicsKernel::processMasked<(int)Masks, Dynamic, Metered, MidSide && hasMidSide, Enveloped>... } };
+	}
+
+	// Variants of one mask, indexed like the tables in process()
+	template <int Mask, size_t... Variants>
+	static constexpr std::array<ProcessFn, 16> makeVariants(std::index_sequence<Variants...>)
+	{
+		return { { &HarmonicsKernel::processMasked<Mask, (Variants & 1) != 0, (Variants & 2) != 0, (Variants & 4) != 0 && hasMidSide, (Variants & 8) != 0>... } };
+	}
+
+	// Kernel samples until the running engine has faded out
+	int getFadeOutSamples(bool midSide) const;
+
+	typename SecondOrderHighPassSIMD<Vec>::Coefs m_highPassCoefs;
+
+	SecondOrderHighPassSIMD<Vec> m_secondOrderHighPass2;
+	SecondOrderHighPassSIMD<Vec> m_secondOrderHighPass4;
+	SecondOrderHighPassSIMD<Vec> m_secondOrderHighPass6;
+	SecondOrderHighPassSIMD<Vec> m_secondOrderHighPass8;
+
+	// Chebyshev engine
+	ChebyshevShaper<Vec> m_shaper;
+	SecondOrderHighPassSIMD<Vec> m_shaperHighPass;
+	bool m_chebyshev = false;
+
+	// Envelope follower state and the detector input of the current call
+	Vec m_envelope = Vec::broadcast(Sample(0));
+	Vec m_envelopePeak = Vec::broadcast(Sample(0));
+	Vec m_keyPeak = Vec::broadcast(Sample(0));
+	Vec m_drive = Vec::broadcast(Sample(1));
+	Vec m_makeup = Vec::broadcast(Sample(1));
+	Vec m_driveStep = Vec::broadcast(Sample(0));
+	Vec m_makeupStep = Vec::broadcast(Sample(0));
+	Vec m_driveTarget = Vec::broadcast(Sample(1));
+	Vec m_makeupTarget = Vec::broadcast(Sample(1));
+	int m_envelopePhase = 0;
+	const Sample* const* m_sidechain = nullptr;
+	int m_sidechainShift = 0;
+
+	// Ramped values at the end of the last call
+	Sample m_gainValue = Sample(1);
+	Sample m_mixValue = Sample(1);
+	Sample m_volumeValue = Sample(1);
+	Sample m_sideGainValue = Sample(1);
+	Sample m_sideMixValue = Sample(1);
+
+	// Harmonic toggle crossfade
+	float m_weight2 = 1.0f;
+	float m_weight4 = 0.0f;
+	float m_weight6 = 0.0f;
+	float m_weight8 = 0.0f;
+	float m_fadeStep = 1.0f;
+
+	// Side lane toggles, only faded while in mid/side
+	float m_sideWeight2 = 1.0f;
+	float m_sideWeight4 = 0.0f;
+	float m_sideWeight6 = 0.0f;
+	float m_sideWeight8 = 0.0f;
+	bool m_midSide = false;
+	int m_fadeSamples = 1;
+};
+
+template <typename Vec>
+inline void HarmonicsKernel<Vec>::init(int sampleRate)
+{
+	m_fadeStep = 1.0f / fmaxf(1.0f, fadeTimeSeconds * (float)sampleRate);
+	m_fadeSamples = (int)(1.0f / m_fadeStep);
+}
+
+template <typename Vec>
+inline void HarmonicsKernel<Vec>::reset()
+{
+	m_secondOrderHighPass2.reset();
+	m_secondOrderHighPass4.reset();
+	m_secondOrderHighPass6.reset();
+	m_secondOrderHighPass8.reset();
+	m_shaperHighPass.reset();
+	m_envelope = Vec::broadcast(Sample(0));
+	m_envelopePeak = Vec::broadcast(Sample(0));
+	m_keyPeak = Vec::broadcast(Sample(0));
+	m_drive = Vec::broadcast(Sample(1));
+	m_makeup = Vec::broadcast(Sample(1));
+	m_driveStep = Vec::broadcast(Sample(0));
+	m_makeupStep = Vec::broadcast(Sample(0));
+	m_driveTarget = Vec::broadcast(Sample(1));
+	m_makeupTarget = Vec::broadcast(Sample(1));
+	m_envelopePhase = 0;
+}
+
+template <typename Vec>
+inline bool HarmonicsKernel<Vec>::isDecayed(float threshold) const
+{
+	return m_secondOrderHighPass2.isDecayed(threshold)
+		&& m_secondOrderHighPass4.isDecayed(threshold)
+		&& m_secondOrderHighPass6.isDecayed(threshold)
+		&& m_secondOrderHighPass8.isDecayed(threshold)
+		&& m_shaperHighPass.isDecayed(threshold);
+}
+
+template <typename Vec>
+inline void HarmonicsKernel<Vec>::settle(const HarmonicsParams& params)
+{
+	reset();
+
+	const bool classic = ! params.chebyshev;
+
+	m_weight2 = classic && params.button2 ? 1.0f : 0.0f;
+	m_weight4 = classic && params.button4 ? 1.0f : 0.0f;
+	m_weight6 = classic && params.button6 ? 1.0f : 0.0f;
+	m_weight8 = classic && params.button8 ? 1.0f : 0.0f;
+
+	m_sideWeight2 = classic && params.sideButton2 ? 1.0f : 0.0f;
+	m_sideWeight4 = classic && params.sideButton4 ? 1.0f : 0.0f;
+	m_sideWeight6 = classic && params.sideButton6 ? 1.0f : 0.0f;
+	m_sideWeight8 = classic && params.sideButton8 ? 1.0f : 0.0f;
+	m_midSide = params.midSide && Vec::size >= 2;
+
+	m_shaper.setLevels(classic ? ChebyshevLevels() : params.levels, 0);
+	m_shaper.jumpToTarget();
+	m_chebyshev = params.chebyshev;
+}
+
+template <typename Vec>
+inline void HarmonicsKernel<Vec>::process(Sample* const* channels, int numChannels, int samples, const HarmonicsParams& params, HarmonicsMeter* meter)
+{
+	using namespace HarmonicsMask;
+
+	// Indexed by dynamic + 2 * metered + 4 * mid/side + 8 * enveloped
+	static constexpr std::array<ProcessTable, 16> tables = { {
+		makeTable<false, false, false, false>(std::make_index_sequence<17>()),
+		makeTable<true, false, false, false>(std::make_index_sequence<17>()),
+		makeTable<false, true, false, false>(std::make_index_sequence<17>()),
+		makeTable<true, true, false, false>(std::make_index_sequence<17>()),
+		makeTable<false, false, true, false>(std::make_index_sequence<17>()),
+		makeTable<true, false, true, false>(std::make_index_sequence<17>()),
+		makeTable<false, true, true, false>(std::make_index_sequence<17>()),
+		makeTable<true, true, true, false>(std::make_index_sequence<17>()),
+		makeTable<false, false, false, true>(std::make_index_sequence<17>()),
+		makeTable<true, false, false, true>(std::make_index_sequence<17>()),
+		makeTable<false, true, false, true>(std::make_index_sequence<17>()),
+		makeTable<true, true, false, true>(std::make_index_sequence<17>()),
+		makeTable<false, false, true, true>(std::make_index_sequence<17>()),
+		makeTable<true, false, true, true>(std::make_index_sequence<17>()),
+		makeTable<false, true, true, true>(std::make_index_sequence<17>()),
+		makeTable<true, true, true, true>(std::make_index_sequence<17>())
+	} };
+
+	const bool midSide = params.midSide && Vec::size >= 2 && numChannels == 2;
+
+	// Side toggles start from where mid is, then fade to their own buttons
+	if (midSide && ! m_midSide)
+	{
+		m_sideWeight2 = m_weight2;
+		m_sideWeight4 = m_weight4;
+		m_sideWeight6 = m_weight6;
+		m_sideWeight8 = m_weight8;
+	}
+
+	m_midSide = midSide;
+
+	auto run = [&](int mask, const HarmonicsParams& runParams, bool dynamic)
+	{
+		const auto& table = tables[(dynamic ? 1 : 0) + (meter != nullptr ? 2 : 0) + (midSide ? 4 : 0) + (params.envelope ? 8 : 0)];
+		(this->*table[mask])(channels, numChannels, samples, runParams, meter);
+	};
+
+	const bool classicSilent = m_weight2 == 0.0f && m_weight4 == 0.0f && m_weight6 == 0.0f && m_weight8 == 0.0f
+		&& (! midSide || (m_sideWeight2 == 0.0f && m_sideWeight4 == 0.0f && m_sideWeight6 == 0.0f && m_sideWeight8 == 0.0f));
+
+	// Engine switch: the old engine fades out first, the new one then fades in from silence
+	if (params.chebyshev != m_chebyshev)
+	{
+		const bool faded = m_chebyshev ? m_shaper.isSilent() : classicSilent;
+
+		// The switch falls on the sample the fade ends, however the samples are split into calls.
+		// Rounded up to whole sidechain samples
+		const int keySamples = 1 << m_sidechainShift;
+		const int fadeSamples = faded ? 0 : (getFadeOutSamples(midSide) + keySamples - 1) & ~(keySamples - 1);
+
+		if (fadeSamples > 0 && fadeSamples < samples)
+		{
+			Sample* rest[Vec::size];
+			const Sample* restKey[Vec::size];
+			const Sample* const* sidechain = m_sidechain;
+
+			process(channels, numChannels, fadeSamples, params, meter);
+
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				rest[channel] = channels[channel] + fadeSamples;
+				restKey[channel] = sidechain != nullptr ? sidechain[channel] + (fadeSamples >> m_sidechainShift) : nullptr;
+			}
+
+			m_sidechain = sidechain != nullptr ? restKey : nullptr;
+			process(rest, numChannels, samples - fadeSamples, params.skip(fadeSamples), meter);
+			m_sidechain = sidechain;
+			return;
+		}
+
+		if (faded)
+		{
+			m_chebyshev = params.chebyshev;
+
+			if (m_chebyshev)
+			{
+				m_shaper.reset();
+				m_shaperHighPass.reset();
+			}
+		}
+	}
+
+	if (m_chebyshev)
+	{
+		m_shaper.setLevels(params.chebyshev ? params.levels : ChebyshevLevels(), m_fadeSamples);
+
+		run(chebyshev, params, m_shaper.isRamping() || params.isRamping());
+		return;
+	}
+
+	// Buttons count as off while fading out towards the Chebyshev engine
+	HarmonicsParams classicParams = params;
+
+	if (params.chebyshev)
+	{
+		classicParams.button2 = false;
+		classicParams.button4 = false;
+		classicParams.button6 = false;
+		classicParams.button8 = false;
+
+		classicParams.sideButton2 = false;
+		classicParams.sideButton4 = false;
+		classicParams.sideButton6 = false;
+		classicParams.sideButton8 = false;
+	}
+
+	// Mid/side runs the harmonics either lane needs, the weights mute them per lane
+	const int targetMask = fromParams(classicParams) | (midSide ? fromSideParams(classicParams) : 0);
+
+	// Harmonics still audible from before keep running until they faded out
+	int audibleMask = (m_weight2 > 0.0f ? h2 : 0) | (m_weight4 > 0.0f ? h4 : 0) | (m_weight6 > 0.0f ? h6 : 0) | (m_weight8 > 0.0f ? h8 : 0);
+
+	if (midSide)
+	{
+		audibleMask |= (m_sideWeight2 > 0.0f ? h2 : 0) | (m_sideWeight4 > 0.0f ? h4 : 0) | (m_sideWeight6 > 0.0f ? h6 : 0) | (m_sideWeight8 > 0.0f ? h8 : 0);
+	}
+
+	const int runMask = targetMask | audibleMask;
+
+	// Stages nothing audible depends on start from silence, whether they were skipped or ran
+	// muted, so the state does not depend on where the calls start
+	const int newStages = stagesFor(runMask) & ~stagesFor(audibleMask);
+
+	if (newStages & h2) m_secondOrderHighPass2.reset();
+	if (newStages & h4) m_secondOrderHighPass4.reset();
+	if (newStages & h6) m_secondOrderHighPass6.reset();
+	if (newStages & h8) m_secondOrderHighPass8.reset();
+
+	bool fading = m_weight2 != (float)classicParams.button2 || m_weight4 != (float)classicParams.button4 || m_weight6 != (float)classicParams.button6 || m_weight8 != (float)classicParams.button8;
+
+	if (midSide)
+	{
+		fading = fading || m_sideWeight2 != (float)classicParams.sideButton2 || m_sideWeight4 != (float)classicParams.sideButton4
+			|| m_sideWeight6 != (float)classicParams.sideButton6 || m_sideWeight8 != (float)classicParams.sideButton8;
+	}
+
+	run(runMask, classicParams, fading || params.isRamping());
+}
+
+template <typename Vec>
+inline int HarmonicsKernel<Vec>::getFadeOutSamples(bool midSide) const
+{
+	if (m_chebyshev)
+	{
+		return m_shaper.getRampSamples();
+	}
+
+	// Same steps as the dynamic variants take, down to exactly 0
+	auto samplesToSilence = [this](float weight)
+	{
+		int samples = 0;
+
+		for (; weight > 0.0f; ++samples)
+		{
+			weight = fminf(1.0f, fmaxf(0.0f, weight - m_fadeStep));
+		}
+
+		return samples;
+	};
+
+	int samples = std::max(std::max(samplesToSilence(m_weight2), samplesToSilence(m_weight4)), std::max(samplesToSilence(m_weight6), samplesToSilence(m_weight8)));
+
+	if (midSide)
+	{
+		samples = std::max(samples, std::max(std::max(samplesToSilence(m_sideWeight2), samplesToSilence(m_sideWeight4)),
+											 std::max(samplesToSilence(m_sideWeight6), samplesToSilence(m_sideWeight8))));
+	}
+
+	return samples;
+}
+
+template <typename Vec>
+template <int Mask>
+inline void HarmonicsKernel<Vec>::processStages(Sample* const* channels, int numChannels, int samples, const HarmonicsParams& params, HarmonicsMeter* meter)
+{
+	static constexpr std::array<ProcessFn, 16> variants = makeVariants<Mask>(std::make_index_sequence<16>());
+
+	// Settled to the same buttons on both lanes, nothing fades
+	const bool midSide = params.midSide && Vec::size >= 2 && numChannels == 2;
+	m_midSide = midSide;
+
+	bool dynamic = params.isRamping();
+
+	if (Mask == HarmonicsMask::chebyshev)
+	{
+		m_shaper.setLevels(params.levels, m_fadeSamples);
+		dynamic = dynamic || m_shaper.isRamping();
+	}
+
+	(this->*variants[(dynamic ? 1 : 0) + (meter != nullptr ? 2 : 0) + (midSide ? 4 : 0) + (params.envelope ? 8 : 0)])(channels, numChannels, samples, params, meter);
+}
+
+template <typename Vec>
+template <int Mask, bool Dynamic, bool Metered, bool MidSide, bool Enveloped>
+inline void HarmonicsKernel<Vec>::processMasked(Sample* const* channels, int numChannels, int samples, const HarmonicsParams& params, HarmonicsMeter* meter)
+{
+	using namespace HarmonicsMask;
+
+	constexpr int stages = stagesFor(Mask);
+
+	// Mid in even lanes and side in odd ones
+	auto perLane = [](Sample mid, Sample side) { return MidSide ? lanePair<Vec>(mid, side) : Vec::broadcast(mid); };
+
+	Vec gain = perLane(params.gain, params.sideGain);
+	Vec mix = perLane(params.mix, params.sideMix);
+	Vec mixInverse = perLane(Sample(1) - Sample(params.mix), Sample(1) - Sample(params.sideMix));
+	Vec volume = Vec::broadcast(params.volume);
+
+	// Parameter ramps, only used by the dynamic variants
+	const bool rampContinues = Dynamic && params.rampContinues;
+
+	Sample gainValue = rampContinues ? m_gainValue : params.gain;
+	Sample mixValue = rampContinues ? m_mixValue : params.mix;
+	Sample volumeValue = rampContinues ? m_volumeValue : params.volume;
+	Sample sideGainValue = rampContinues ? m_sideGainValue : params.sideGain;
+	Sample sideMixValue = rampContinues ? m_sideMixValue : params.sideMix;
+
+	const Vec vGain2 = Vec::broadcast(gain2);
+	const Vec vGain4 = Vec::broadcast(gain4);
+	const Vec vGain6 = Vec::broadcast(gain6);
+	const Vec vGain8 = Vec::broadcast(gain8);
+
+	const Vec limitLow = Vec::broadcast(-Sample(params.clipLevel));
+	const Vec limitHigh = Vec::broadcast(Sample(params.clipLevel));
+
+	const Vec shaperLow = Vec::broadcast(Sample(-1));
+	const Vec shaperHigh = Vec::broadcast(Sample(1));
+
+	// Crossfade ramps, only used by the dynamic variants
+	float weight2 = m_weight2;
+	float weight4 = m_weight4;
+	float weight6 = m_weight6;
+	float weight8 = m_weight8;
+
+	const float step2 = params.button2 ? m_fadeStep : -m_fadeStep;
+	const float step4 = params.button4 ? m_fadeStep : -m_fadeStep;
+	const float step6 = params.button6 ? m_fadeStep : -m_fadeStep;
+	const float step8 = params.button8 ? m_fadeStep : -m_fadeStep;
+
+	float sideWeight2 = m_sideWeight2;
+	float sideWeight4 = m_sideWeight4;
+	float sideWeight6 = m_sideWeight6;
+	float sideWeight8 = m_sideWeight8;
+
+	const float sideStep2 = params.sideButton2 ? m_fadeStep : -m_fadeStep;
+	const float sideStep4 = params.sideButton4 ? m_fadeStep : -m_fadeStep;
+	const float sideStep6 = params.sideButton6 ? m_fadeStep : -m_fadeStep;
+	const float sideStep8 = params.sideButton8 ? m_fadeStep : -m_fadeStep;
+
+	// Mid/side weights per lane, 0 or 1 once settled so the steady variants still mute per lane
+	Vec laneWeight2 = perLane(weight2, sideWeight2);
+	Vec laneWeight4 = perLane(weight4, sideWeight4);
+	Vec laneWeight6 = perLane(weight6, sideWeight6);
+	Vec laneWeight8 = perLane(weight8, sideWeight8);
+
+	// Level accumulators, only used by the metered variants
+	const Vec zero = Vec::broadcast(Sample(0));
+	Vec sumSquares[HarmonicsMeter::numLevels];
+	Vec peak[HarmonicsMeter::numLevels];
+
+	for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+	{
+		sumSquares[level] = zero;
+		peak[level] = zero;
+	}
+
+	auto measure = [&sumSquares, &peak, zero](int level, Vec value)
+	{
+		sumSquares[level] = sumSquares[level] + value * value;
+		peak[level] = Vec::max(peak[level], Vec::max(value, zero - value));
+	};
+
+	Vec driveSumSquares = zero;
+	Vec clipped = zero;
+
+	auto measureClip = [&measure, &driveSumSquares, &clipped, zero, limitHigh](Vec drive, Vec dist, Vec limit)
+	{
+		measure(HarmonicsMeter::harmonics, dist);
+		measure(HarmonicsMeter::clippedHarmonics, limit);
+		driveSumSquares = driveSumSquares + drive * drive;
+		clipped = clipped + Vec::isAbove(Vec::max(dist, zero - dist), limitHigh);
+	};
+
+	// Load all filter state into registers for the whole block
+	auto secondOrderHighPass2 = m_secondOrderHighPass2;
+	auto secondOrderHighPass4 = m_secondOrderHighPass4;
+	auto secondOrderHighPass6 = m_secondOrderHighPass6;
+	auto secondOrderHighPass8 = m_secondOrderHighPass8;
+	auto shaper = m_shaper;
+	auto shaperHighPass = m_shaperHighPass;
+	const auto highPassCoefs = m_highPassCoefs;
+
+	// Envelope follower, only used by the enveloped variants. The squaring chain has the makeup folded
+	// into the second harmonic gain, drive * drive * makeup is the drive again, so its drive ramps
+	// pre-scaled by gain2 and takes the place of that gain. gain2 is a power of two, the scaling is exact
+	// and both engines leave the same drive behind
+	const Vec driveScale = Vec::broadcast(Sample(Mask == chebyshev ? 1.0f : gain2));
+	const Vec driveUnscale = Vec::broadcast(Sample(Mask == chebyshev ? 1.0f : 1.0f / gain2));
+
+	Vec envelope = m_envelope;
+	Vec envelopePeak = m_envelopePeak;
+	Vec keyPeak = m_keyPeak;
+	Vec drive = driveScale * m_drive;
+	Vec makeup = m_makeup;
+	Vec driveStep = driveScale * m_driveStep;
+	Vec makeupStep = m_makeupStep;
+	Vec driveTarget = driveScale * m_driveTarget;
+	Vec makeupTarget = m_makeupTarget;
+	int envelopePhase = m_envelopePhase;
+
+	const Vec attack = Vec::broadcast(Sample(params.envelopeAttack));
+	const Vec release = Vec::broadcast(Sample(params.envelopeRelease));
+	const Vec intervalInverse = Vec::broadcast(Sample(1) / Sample(envelopeInterval));
+	const Vec envelopeFloor = Vec::broadcast(Sample(envelopeReference / envelopeMaxDrive));
+	const Vec depthInverse = Vec::broadcast(Sample(1) - Sample(params.envelopeDepth));
+	const Vec depthReference = Vec::broadcast(Sample(params.envelopeDepth) * Sample(envelopeReference));
+
+	const Sample* const* sidechain = m_sidechain;
+	const int sidechainShift = m_sidechainShift;
+
+	for (int sample = 0; sample < samples;)
+	{
+		int end = samples;
+
+		// Enveloped variants step the follower once per interval and run the samples up to the next
+		// step without it, the interval runs on across calls so the result does not depend on the block size
+		if (Enveloped)
+		{
+			if (envelopePhase == 0)
+			{
+				// The ramps head for the targets of the last step. The new targets are not needed
+				// before the next one, so their divisions run alongside the samples instead of holding them up
+				driveStep = (driveTarget - drive) * intervalInverse;
+
+				if (Mask == chebyshev)
+				{
+					makeupStep = (makeupTarget - makeup) * intervalInverse;
+				}
+
+				// Rising, the attack step is the larger one and falling the release step is,
+				// so the max picks the right one without a branch
+				const Vec delta = (sidechain != nullptr ? keyPeak : envelopePeak) - envelope;
+				envelope = envelope + Vec::max(attack * delta, release * delta);
+				envelopePeak = zero;
+				keyPeak = zero;
+
+				// drive = (1 - depth) + depth * reference / level, makeup is its inverse
+				const Vec level = Vec::max(envelope, envelopeFloor);
+				const Vec target = depthInverse * level + depthReference;
+
+				driveTarget = driveScale * (target / level);
+
+				if (Mask == chebyshev)
+				{
+					makeupTarget = level / target;
+				}
+			}
+
+			end = std::min(samples, sample + envelopeInterval - envelopePhase);
+			envelopePhase = (envelopePhase + end - sample) & (envelopeInterval - 1);
+
+			// A sidechain is peaked up front at its own rate, the samples below always take the input's
+			// peak and leave it unused, which keeps the choice out of the per sample loop
+			if (sidechain != nullptr)
+			{
+				for (int position = sample >> sidechainShift; position <= (end - 1) >> sidechainShift; ++position)
+				{
+					keyPeak = Vec::max(keyPeak, Vec::abs(ChannelIO<MidSide>::template load<Vec>(sidechain, numChannels, position)));
+				}
+			}
+		}
+
+		for (; sample < end; ++sample)
+		{
+			if (Dynamic)
+			{
+				if (sample < params.gainRampSamples) gainValue *= params.gainRatio;
+				if (sample < params.mixRampSamples) mixValue += params.mixStep;
+				if (sample < params.volumeRampSamples) volumeValue *= params.volumeRatio;
+
+				if (MidSide)
+				{
+					if (sample < params.sideGainRampSamples) sideGainValue *= params.sideGainRatio;
+					if (sample < params.sideMixRampSamples) sideMixValue += params.sideMixStep;
+				}
+
+				gain = perLane(gainValue, sideGainValue);
+				mix = perLane(mixValue, sideMixValue);
+				mixInverse = perLane(Sample(1) - mixValue, Sample(1) - sideMixValue);
+				volume = Vec::broadcast(volumeValue);
+			}
+
+			// Get input, mid/side encodes the pair on the way in
+			const Vec raw = ChannelIO<MidSide>::template load<Vec>(channels, numChannels, sample);
+			const Vec in = raw * gain;
+
+			Vec out = mixInverse * in;
+
+			if (Enveloped)
+			{
+				envelopePeak = Vec::max(envelopePeak, Vec::abs(raw));
+				drive = drive + driveStep;
+
+				if (Mask == chebyshev)
+				{
+					makeup = makeup + makeupStep;
+				}
+			}
+
+			// Harmonic chain input, the dry path keeps the fixed gain. The squaring chain applies
+			// the drive with the second harmonic gain instead
+			const Vec inDrive = Enveloped && Mask == chebyshev ? in * drive : in;
+
+			if (Mask == chebyshev)
+			{
+				if (Dynamic)
+				{
+					shaper.advance();
+				}
+
+				// Polynomial only holds its harmonic levels within -1..1
+				const Vec inShaper = Vec::max(shaperLow, Vec::min(shaperHigh, inDrive));
+				Vec inDist = shaperHighPass.process(shaper.process(inShaper), highPassCoefs);
+
+				if (Enveloped)
+				{
+					inDist = makeup * inDist;
+				}
+
+				const Vec inLimit = Vec::max(limitLow, Vec::min(limitHigh, inDist));
+
+				if (Metered)
+				{
+					measureClip(inDrive, inDist, inLimit);
+				}
+
+				out = mix * inLimit + out;
+			}
+			else if (Mask != 0)
+			{
+				Vec inFilter2 = Vec::broadcast(Sample(0));
+				Vec inFilter4 = Vec::broadcast(Sample(0));
+				Vec inFilter6 = Vec::broadcast(Sample(0));
+				Vec inFilter8 = Vec::broadcast(Sample(0));
+
+				if (stages & h2)
+				{
+					const Vec inDist2 = inDrive * inDrive * (Enveloped ? drive : vGain2);
+					inFilter2 = secondOrderHighPass2.process(inDist2, highPassCoefs);
+				}
+
+				if (stages & h4)
+				{
+					const Vec inDist4 = inFilter2 * inFilter2 * vGain4;
+					inFilter4 = secondOrderHighPass4.process(inDist4, highPassCoefs);
+				}
+
+				if (stages & h6)
+				{
+					const Vec inDist6 = inFilter2 * inFilter4 * vGain6;
+					inFilter6 = secondOrderHighPass6.process(inDist6, highPassCoefs);
+				}
+
+				if (stages & h8)
+				{
+					const Vec inDist8 = inFilter4 * inFilter4 * vGain8;
+					inFilter8 = secondOrderHighPass8.process(inDist8, highPassCoefs);
+				}
+
+				if (Dynamic)
+				{
+					weight2 = fminf(1.0f, fmaxf(0.0f, weight2 + step2));
+					weight4 = fminf(1.0f, fmaxf(0.0f, weight4 + step4));
+					weight6 = fminf(1.0f, fmaxf(0.0f, weight6 + step6));
+					weight8 = fminf(1.0f, fmaxf(0.0f, weight8 + step8));
+
+					if (MidSide)
+					{
+						sideWeight2 = fminf(1.0f, fmaxf(0.0f, sideWeight2 + sideStep2));
+						sideWeight4 = fminf(1.0f, fmaxf(0.0f, sideWeight4 + sideStep4));
+						sideWeight6 = fminf(1.0f, fmaxf(0.0f, sideWeight6 + sideStep6));
+						sideWeight8 = fminf(1.0f, fmaxf(0.0f, sideWeight8 + sideStep8));
+
+						laneWeight2 = perLane(weight2, sideWeight2);
+						laneWeight4 = perLane(weight4, sideWeight4);
+						laneWeight6 = perLane(weight6, sideWeight6);
+						laneWeight8 = perLane(weight8, sideWeight8);
+					}
+					else
+					{
+						laneWeight2 = Vec::broadcast(weight2);
+						laneWeight4 = Vec::broadcast(weight4);
+						laneWeight6 = Vec::broadcast(weight6);
+						laneWeight8 = Vec::broadcast(weight8);
+					}
+				}
+
+				if (Dynamic || MidSide)
+				{
+					if (Mask & h2) inFilter2 = laneWeight2 * inFilter2;
+					if (Mask & h4) inFilter4 = laneWeight4 * inFilter4;
+					if (Mask & h6) inFilter6 = laneWeight6 * inFilter6;
+					if (Mask & h8) inFilter8 = laneWeight8 * inFilter8;
+				}
+
+				Vec inDist = Vec::broadcast(Sample(0));
+
+				if (Mask & h2) inDist = inDist + inFilter2;
+				if (Mask & h4) inDist = inDist + inFilter4;
+				if (Mask & h6) inDist = inDist + inFilter6;
+				if (Mask & h8) inDist = inDist + inFilter8;
+
+				const Vec inLimit = Vec::max(limitLow, Vec::min(limitHigh, inDist));
+
+				if (Metered)
+				{
+					if (Mask & h2) measure(HarmonicsMeter::harmonic2, inFilter2);
+					if (Mask & h4) measure(HarmonicsMeter::harmonic4, inFilter4);
+					if (Mask & h6) measure(HarmonicsMeter::harmonic6, inFilter6);
+					if (Mask & h8) measure(HarmonicsMeter::harmonic8, inFilter8);
+
+					measureClip(Enveloped ? inDrive * (drive * driveUnscale) : inDrive, inDist, inLimit);
+				}
+
+				out = mix * inLimit + out;
+			}
+
+			// Apply volume and send to output, mid/side decodes back to the pair
+			out = volume * out;
+
+			ChannelIO<MidSide>::store(out, channels, numChannels, sample);
+		}
+	}
+
+	m_secondOrderHighPass2 = secondOrderHighPass2;
+	m_secondOrderHighPass4 = secondOrderHighPass4;
+	m_secondOrderHighPass6 = secondOrderHighPass6;
+	m_secondOrderHighPass8 = secondOrderHighPass8;
+
+	if (Mask == chebyshev)
+	{
+		m_shaper = shaper;
+		m_shaperHighPass = shaperHighPass;
+	}
+
+	m_gainValue = gainValue;
+	m_mixValue = mixValue;
+	m_volumeValue = volumeValue;
+	m_sideGainValue = sideGainValue;
+	m_sideMixValue = sideMixValue;
+
+	if (Enveloped)
+	{
+		m_envelope = envelope;
+		m_envelopePeak = envelopePeak;
+		m_keyPeak = keyPeak;
+		m_drive = driveUnscale * drive;
+		m_makeup = makeup;
+		m_driveStep = driveUnscale * driveStep;
+		m_makeupStep = makeupStep;
+		m_driveTarget = driveUnscale * driveTarget;
+		m_makeupTarget = makeupTarget;
+		m_envelopePhase = envelopePhase;
+	}
+
+	if (Dynamic)
+	{
+		m_weight2 = weight2;
+		m_weight4 = weight4;
+		m_weight6 = weight6;
+		m_weight8 = weight8;
+
+		if (MidSide)
+		{
+			m_sideWeight2 = sideWeight2;
+			m_sideWeight4 = sideWeight4;
+			m_sideWeight6 = sideWeight6;
+			m_sideWeight8 = sideWeight8;
+		}
+	}
+
+	if (Metered)
+	{
+		alignas(16) Sample lanes[Vec::size];
+
+		for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+		{
+			sumSquares[level].store(lanes);
+
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				meter->sumSquares[level] += (float)lanes[channel];
+			}
+
+			peak[level].store(lanes);
+
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				meter->peak[level] = fmaxf(meter->peak[level], (float)lanes[channel]);
+			}
+		}
+
+		driveSumSquares.store(lanes);
+
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			meter->driveSumSquares += (float)lanes[channel];
+		}
+
+		clipped.store(lanes);
+
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			meter->clipped += (int)lanes[channel];
+		}
+
+		meter->samples += samples * numChannels;
+	}
+}
@@ -0,0 +1,302 @@
+/*
+  ==============================================================================
+
+    LookaheadLimiter.h
+    True-peak limiter with lookahead, all channels share one gain.
+
+    The detector interpolates every channel 4x with a polyphase Kaiser
+    windowed sinc and takes the largest absolute value, so peaks between
+    samples count too. The gain each detected sample needs is held over the
+    lookahead window with a sliding minimum (monotonic deque, O(1) amortised
+    per sample), released with a one-pole towards unity and then averaged
+    over the same window. Every value in the average is at most the gain the
+    oldest sample of the window needs, so the ramp reaches it exactly when
+    that sample leaves the delay line and the audio never passes the ceiling.
+    The average is a running sum, recomputed from the window once per window
+    length so rounding error cannot build up.
+
+    Latency is the lookahead plus the half length of the interpolator.
+    Everything is allocated in prepare(), process() works in place.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Oversampler.h"
+
+//==============================================================================
+template <typename SampleType>
+class LookaheadLimiter
+{
+public:
+	static const int TRUE_PEAK_FACTOR = 4;
+	static const int TRUE_PEAK_TAPS = 16;			// Per phase
+	static const int DETECTOR_DELAY = TRUE_PEAK_TAPS / 2;
+
+	LookaheadLimiter();
+
+	// Allocates for maxLookahead samples, nothing is allocated afterwards
+	void prepare(int numChannels, double sampleRate, int maxLookahead);
+	void release();
+	void reset();
+
+	// Clears the state, the delay line restarts from silence
+	void setLookahead(int samples);
+	void setCeiling(SampleType ceiling) { m_ceiling = ceiling; };
+	void setReleaseTime(double seconds);
+
+	int getLatency() const { return m_lookahead + DETECTOR_DELAY; };
+
+	void process(SampleType* const* channels, int numChannels, int samples);
+
+protected:
+	SampleType detectPeak(const SampleType* const* channels, int numChannels, int sample);
+
+	// Interpolator phases 1..3, taps newest first. Phase 0 is the delayed sample itself
+	SampleType m_phases[TRUE_PEAK_FACTOR][TRUE_PEAK_TAPS] = {};
+
+	// History per channel, written twice so the newest TRUE_PEAK_TAPS samples are always contiguous
+	std::vector<SampleType> m_history;
+	int m_historyPosition = 0;
+
+	// Delay line per channel, power of two
+	std::vector<SampleType> m_delay;
+	int m_delaySize = 0;
+	int m_delayPosition = 0;
+
+	// Sliding minimum of the required gain, ring buffers of 'window' entries
+	std::vector<SampleType> m_dequeGains;
+	std::vector<long long> m_dequeIndices;
+	int m_dequeHead = 0;
+	int m_dequeCount = 0;
+	long long m_index = 0;
+
+	// Moving average over the window
+	std::vector<SampleType> m_average;
+	int m_averagePosition = 0;
+	double m_averageSum = 0.0;
+
+	SampleType m_ceiling = SampleType(1);
+	SampleType m_releaseCoef = SampleType(0);
+	SampleType m_released = SampleType(1);
+
+	double m_sampleRate = 48000.0;
+	int m_numChannels = 0;
+	int m_maxLookahead = 0;
+	int m_lookahead = 0;
+};
+
+template <typename SampleType>
+inline LookaheadLimiter<SampleType>::LookaheadLimiter()
+{
+	// Prototype of TRUE_PEAK_FACTOR * TRUE_PEAK_TAPS + 1 taps centred on DETECTOR_DELAY input samples
+	const double pi = 3.14159265358979323846;
+	const int centre = TRUE_PEAK_FACTOR * DETECTOR_DELAY;
+	const double beta = 7.0;
+	const double window = HalfBandCoefs<double>::besselI0(beta);
+
+	for (int phase = 1; phase < TRUE_PEAK_FACTOR; ++phase)
+	{
+		double taps[TRUE_PEAK_TAPS];
+		double sum = 0.0;
+
+		for (int tap = 0; tap < TRUE_PEAK_TAPS; ++tap)
+		{
+			const double n = (double)(tap * TRUE_PEAK_FACTOR + phase - centre) / TRUE_PEAK_FACTOR;
+			const double ratio = n * TRUE_PEAK_FACTOR / centre;
+			const double kaiser = HalfBandCoefs<double>::besselI0(beta * std::sqrt(std::fmax(0.0, 1.0 - ratio * ratio))) / window;
+
+			taps[tap] = std::sin(pi * n) / (pi * n) * kaiser;
+			sum += taps[tap];
+		}
+
+		// Unity DC gain per phase
+		for (int tap = 0; tap < TRUE_PEAK_TAPS; ++tap)
+		{
+			m_phases[phase][tap] = (SampleType)(taps[tap] / sum);
+		}
+	}
+}
+
+template <typename SampleType>
+inline void LookaheadLimiter<SampleType>::prepare(int numChannels, double sampleRate, int maxLookahead)
+{
+	m_numChannels = numChannels;
+	m_sampleRate = sampleRate;
+	m_maxLookahead = std::max(0, maxLookahead);
+
+	m_history.assign((size_t)numChannels * 2 * TRUE_PEAK_TAPS, SampleType(0));
+
+	m_delaySize = 1;
+
+	while (m_delaySize <= m_maxLookahead + DETECTOR_DELAY)
+	{
+		m_delaySize *= 2;
+	}
+
+	m_delay.assign((size_t)numChannels * m_delaySize, SampleType(0));
+
+	m_dequeGains.assign(m_maxLookahead + 1, SampleType(1));
+	m_dequeIndices.assign(m_maxLookahead + 1, 0);
+	m_average.assign(m_maxLookahead + 1, SampleType(1));
+
+	m_lookahead = std::min(m_lookahead, m_maxLookahead);
+	setReleaseTime(0.05);
+	reset();
+}
+
+template <typename SampleType>
+inline void LookaheadLimiter<SampleType>::release()
+{
+	std::vector<SampleType>().swap(m_history);
+	std::vector<SampleType>().swap(m_delay);
+	std::vector<SampleType>().swap(m_dequeGains);
+	std::vector<long long>().swap(m_dequeIndices);
+	std::vector<SampleType>().swap(m_average);
+
+	m_numChannels = 0;
+	m_maxLookahead = 0;
+	m_lookahead = 0;
+}
+
+template <typename SampleType>
+inline void LookaheadLimiter<SampleType>::reset()
+{
+	std::fill(m_history.begin(), m_history.end(), SampleType(0));
+	std::fill(m_delay.begin(), m_delay.end(), SampleType(0));
+	std::fill(m_average.begin(), m_average.end(), SampleType(1));
+
+	m_historyPosition = 0;
+	m_delayPosition = 0;
+	m_dequeHead = 0;
+	m_dequeCount = 0;
+	m_index = 0;
+	m_averagePosition = 0;
+	m_averageSum = (double)(m_lookahead + 1);
+	m_released = SampleType(1);
+}
+
+template <typename SampleType>
+inline void LookaheadLimiter<SampleType>::setLookahead(int samples)
+{
+	m_lookahead = std::max(0, std::min(samples, m_maxLookahead));
+	reset();
+}
+
+template <typename SampleType>
+inline void LookaheadLimiter<SampleType>::setReleaseTime(double seconds)
+{
+	m_releaseCoef = (SampleType)(1.0 - std::exp(-1.0 / std::max(1.0, seconds * m_sampleRate)));
+}
+
+template <typename SampleType>
+inline SampleType LookaheadLimiter<SampleType>::detectPeak(const SampleType* const* channels, int numChannels, int sample)
+{
+	SampleType peak = SampleType(0);
+
+	for (int channel = 0; channel < numChannels; ++channel)
+	{
+		SampleType* history = m_history.data() + (size_t)channel * 2 * TRUE_PEAK_TAPS;
+		const SampleType in = channels[channel][sample];
+
+		history[m_historyPosition] = in;
+		history[m_historyPosition + TRUE_PEAK_TAPS] = in;
+
+		// Newest first
+		const SampleType* newest = history + m_historyPosition + TRUE_PEAK_TAPS;
+
+		peak = std::max(peak, std::abs(newest[-DETECTOR_DELAY]));
+
+		for (int phase = 1; phase < TRUE_PEAK_FACTOR; ++phase)
+		{
+			SampleType sum = SampleType(0);
+
+			for (int tap = 0; tap < TRUE_PEAK_TAPS; ++tap)
+			{
+				sum += m_phases[phase][tap] * newest[-tap];
+			}
+
+			peak = std::max(peak, std::abs(sum));
+		}
+	}
+
+	m_historyPosition = (m_historyPosition + 1) % TRUE_PEAK_TAPS;
+	return peak;
+}
+
+template <typename SampleType>
+inline void LookaheadLimiter<SampleType>::process(SampleType* const* channels, int numChannels, int samples)
+{
+	numChannels = std::min(numChannels, m_numChannels);
+
+	if (numChannels == 0)
+	{
+		return;
+	}
+
+	const int window = m_lookahead + 1;
+	const int latency = getLatency();
+	const int delayMask = m_delaySize - 1;
+
+	for (int sample = 0; sample < samples; ++sample)
+	{
+		const SampleType peak = detectPeak(channels, numChannels, sample);
+		const SampleType required = peak > m_ceiling ? m_ceiling / peak : SampleType(1);
+
+		// Sliding minimum over the last 'window' samples. The oldest entry leaves first,
+		// larger gains behind the new one can never be the minimum again
+		if (m_dequeCount > 0 && m_dequeIndices[m_dequeHead] <= m_index - window)
+		{
+			m_dequeHead = (m_dequeHead + 1) % window;
+			--m_dequeCount;
+		}
+
+		while (m_dequeCount > 0 && m_dequeGains[(m_dequeHead + m_dequeCount - 1) % window] >= required)
+		{
+			--m_dequeCount;
+		}
+
+		m_dequeGains[(m_dequeHead + m_dequeCount) % window] = required;
+		m_dequeIndices[(m_dequeHead + m_dequeCount) % window] = m_index;
+		++m_dequeCount;
+
+		const SampleType held = m_dequeGains[m_dequeHead];
+		++m_index;
+
+		// Release towards unity, never above what the window needs
+		m_released = std::min(held, m_released + (SampleType(1) - m_released) * m_releaseCoef);
+
+		m_averageSum += (double)m_released - (double)m_average[m_averagePosition];
+		m_average[m_averagePosition] = m_released;
+		m_averagePosition = m_averagePosition + 1 < window ? m_averagePosition + 1 : 0;
+
+		// The running sum picks up rounding error forever, summed again from the window once per window length
+		if (m_averagePosition == 0)
+		{
+			m_averageSum = 0.0;
+
+			for (int index = 0; index < window; ++index)
+			{
+				m_averageSum += (double)m_average[index];
+			}
+		}
+
+		const SampleType gain = (SampleType)(m_averageSum / window);
+
+		// Delay the audio to the detector position of the oldest sample in the window
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			SampleType* delay = m_delay.data() + (size_t)channel * m_delaySize;
+
+			delay[m_delayPosition] = channels[channel][sample];
+			channels[channel][sample] = gain * delay[(m_delayPosition - latency) & delayMask];
+		}
+
+		m_delayPosition = (m_delayPosition + 1) & delayMask;
+	}
+}
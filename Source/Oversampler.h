@@ -0,0 +1,400 @@
+/*
+  ==============================================================================
+
+    Oversampler.h
+    2x/4x/8x oversampling from cascaded polyphase half-band FIR stages, in
+    float or double.
+
+    Each stage is a Kaiser windowed linear-phase half-band filter. Every
+    second tap of a half-band filter is zero, so the polyphase up/down
+    sampler only runs the non-zero taps, the other phase is a pure delay
+    through the centre tap. Symmetric taps are folded to halve the multiplies.
+
+    A stage with centre tap M delays by M samples at its own rate on the way
+    up and on the way down, so the round trip latency is
+    M1 + M2 / 2 + M3 / 4 samples at the base rate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//==============================================================================
+template <typename SampleType>
+class HalfBandCoefs
+{
+public:
+	// centre has to be odd, the filter has 2 * centre + 1 taps
+	void design(int centre, float beta);
+
+	int getCentre() const { return m_centre; };
+
+	// Non-zero taps h[0], h[2], ... h[2 * centre], gain 1 at DC
+	const std::vector<SampleType>& getTaps() const { return m_taps; };
+
+	// Modified Bessel function of order 0, for the Kaiser window
+	static double besselI0(double x);
+
+protected:
+	std::vector<SampleType> m_taps;
+	int m_centre = 0;
+};
+
+template <typename SampleType>
+inline double HalfBandCoefs<SampleType>::besselI0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+
+	for (int k = 1; k < 50; ++k)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+
+		if (term < sum * 1e-12)
+		{
+			break;
+		}
+	}
+
+	return sum;
+}
+
+template <typename SampleType>
+inline void HalfBandCoefs<SampleType>::design(int centre, float beta)
+{
+	const double pi = 3.14159265358979323846;
+
+	m_centre = centre;
+	m_taps.assign(centre + 1, SampleType(0));
+
+	const double window = besselI0(beta);
+	double sum = 0.0;
+
+	for (int tap = 0; tap <= centre; ++tap)
+	{
+		// Distance from the centre is always odd for the kept taps
+		const double n = 2.0 * tap - centre;
+		const double sinc = sin(0.5 * pi * n) / (pi * n);
+		const double ratio = n / centre;
+		const double kaiser = besselI0(beta * sqrt(fmax(0.0, 1.0 - ratio * ratio))) / window;
+
+		m_taps[tap] = (SampleType)(sinc * kaiser);
+		sum += sinc * kaiser;
+	}
+
+	// Together with the 0.5 centre tap the filter has unity DC gain
+	for (auto& tap : m_taps)
+	{
+		tap = (SampleType)(tap * 0.5 / sum);
+	}
+}
+
+//==============================================================================
+template <typename SampleType>
+class HalfBandUpsampler
+{
+public:
+	void init(const HalfBandCoefs<SampleType>& coefs, int maxSamples);
+	void reset();
+
+	// Writes 2 * samples to out
+	void process(const SampleType* in, SampleType* out, int samples);
+
+protected:
+	const HalfBandCoefs<SampleType>* m_coefs = nullptr;
+
+	// Last 'centre' inputs followed by the current block
+	std::vector<SampleType> m_buffer;
+	std::vector<SampleType> m_accumulator;
+};
+
+template <typename SampleType>
+inline void HalfBandUpsampler<SampleType>::init(const HalfBandCoefs<SampleType>& coefs, int maxSamples)
+{
+	m_coefs = &coefs;
+	m_buffer.assign(coefs.getCentre() + maxSamples, SampleType(0));
+	m_accumulator.assign(maxSamples, SampleType(0));
+}
+
+template <typename SampleType>
+inline void HalfBandUpsampler<SampleType>::reset()
+{
+	std::fill(m_buffer.begin(), m_buffer.end(), SampleType(0));
+}
+
+template <typename SampleType>
+inline void HalfBandUpsampler<SampleType>::process(const SampleType* in, SampleType* out, int samples)
+{
+	const auto& taps = m_coefs->getTaps();
+	const int centre = m_coefs->getCentre();
+	const int delay = (centre - 1) / 2;
+
+	SampleType* buffer = m_buffer.data();
+	SampleType* accumulator = m_accumulator.data();
+
+	std::copy(in, in + samples, buffer + centre);
+
+	// Filtered phase, taps outer so every output sums in the same order
+	std::fill(accumulator, accumulator + samples, SampleType(0));
+
+	for (int tap = 0; tap <= delay; ++tap)
+	{
+		const SampleType coef = SampleType(2) * taps[tap];
+		const SampleType* newer = buffer + centre - tap;
+		const SampleType* older = buffer + tap;
+
+		for (int sample = 0; sample < samples; ++sample)
+		{
+			accumulator[sample] += coef * (newer[sample] + older[sample]);
+		}
+	}
+
+	// Other phase is the centre tap only
+	const SampleType* delayed = buffer + centre - delay;
+
+	for (int sample = 0; sample < samples; ++sample)
+	{
+		out[2 * sample] = accumulator[sample];
+		out[2 * sample + 1] = delayed[sample];
+	}
+
+	std::copy(buffer + samples, buffer + samples + centre, buffer);
+}
+
+//==============================================================================
+template <typename SampleType>
+class HalfBandDownsampler
+{
+public:
+	void init(const HalfBandCoefs<SampleType>& coefs, int maxSamples);
+	void reset();
+
+	// Reads 2 * samples from in
+	void process(const SampleType* in, SampleType* out, int samples);
+
+protected:
+	const HalfBandCoefs<SampleType>* m_coefs = nullptr;
+
+	// Last '2 * centre' inputs followed by the current block
+	std::vector<SampleType> m_buffer;
+};
+
+template <typename SampleType>
+inline void HalfBandDownsampler<SampleType>::init(const HalfBandCoefs<SampleType>& coefs, int maxSamples)
+{
+	m_coefs = &coefs;
+	m_buffer.assign(2 * coefs.getCentre() + 2 * maxSamples, SampleType(0));
+}
+
+template <typename SampleType>
+inline void HalfBandDownsampler<SampleType>::reset()
+{
+	std::fill(m_buffer.begin(), m_buffer.end(), SampleType(0));
+}
+
+template <typename SampleType>
+inline void HalfBandDownsampler<SampleType>::process(const SampleType* in, SampleType* out, int samples)
+{
+	const auto& taps = m_coefs->getTaps();
+	const int centre = m_coefs->getCentre();
+	const int history = 2 * centre;
+
+	SampleType* buffer = m_buffer.data();
+
+	std::copy(in, in + 2 * samples, buffer + history);
+
+	// Centre tap
+	const SampleType* delayed = buffer + history - centre;
+
+	for (int sample = 0; sample < samples; ++sample)
+	{
+		out[sample] = SampleType(0.5) * delayed[2 * sample];
+	}
+
+	// Even phase, taps outer so every output sums in the same order
+	for (int tap = 0; tap <= (centre - 1) / 2; ++tap)
+	{
+		const SampleType coef = taps[tap];
+		const SampleType* newer = buffer + history - 2 * tap;
+		const SampleType* older = buffer + 2 * tap;
+
+		for (int sample = 0; sample < samples; ++sample)
+		{
+			out[sample] += coef * (newer[2 * sample] + older[2 * sample]);
+		}
+	}
+
+	std::copy(buffer + 2 * samples, buffer + 2 * samples + history, buffer);
+}
+
+//==============================================================================
+template <typename SampleType>
+class Oversampler
+{
+public:
+	static const int maxFactorLog2 = 3;
+
+	Oversampler();
+
+	// Allocates everything for 8x, nothing is allocated afterwards
+	void init(int numChannels, int maxSamples);
+	void release();
+	void reset();
+
+	void setFactorLog2(int factorLog2);
+	int getFactorLog2() const { return m_factorLog2; };
+
+	// Round trip delay in base rate samples, at the current or any other factor
+	float getLatency() const { return getLatency(m_factorLog2); };
+	float getLatency(int factorLog2) const;
+
+	// Returns the oversampled channels, valid until the next call
+	SampleType* const* upsample(const SampleType* const* channels, int numChannels, int samples);
+	void downsample(SampleType* const* channels, int numChannels, int samples);
+
+protected:
+	HalfBandCoefs<SampleType> m_coefs[maxFactorLog2];
+
+	std::vector<HalfBandUpsampler<SampleType>> m_upsamplers[maxFactorLog2];
+	std::vector<HalfBandDownsampler<SampleType>> m_downsamplers[maxFactorLog2];
+
+	// Two ping-pong buffers per channel, each large enough for 8x
+	std::vector<SampleType> m_buffers;
+	std::vector<SampleType*> m_pointers;
+	int m_bufferSize = 0;
+
+	int m_factorLog2 = 0;
+};
+
+template <typename SampleType>
+inline Oversampler<SampleType>::Oversampler()
+{
+	// Steep first stage, the later ones only have to reject images far above the audio band
+	m_coefs[0].design(31, 8.0f);
+	m_coefs[1].design(15, 8.0f);
+	m_coefs[2].design(7, 8.0f);
+}
+
+template <typename SampleType>
+inline void Oversampler<SampleType>::init(int numChannels, int maxSamples)
+{
+	for (int stage = 0; stage < maxFactorLog2; ++stage)
+	{
+		const int stageSamples = maxSamples << stage;
+
+		m_upsamplers[stage].resize(numChannels);
+		m_downsamplers[stage].resize(numChannels);
+
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			m_upsamplers[stage][channel].init(m_coefs[stage], stageSamples);
+			m_downsamplers[stage][channel].init(m_coefs[stage], stageSamples);
+		}
+	}
+
+	m_bufferSize = maxSamples << maxFactorLog2;
+	m_buffers.assign(2 * numChannels * m_bufferSize, SampleType(0));
+	m_pointers.assign(numChannels, nullptr);
+}
+
+template <typename SampleType>
+inline void Oversampler<SampleType>::release()
+{
+	for (int stage = 0; stage < maxFactorLog2; ++stage)
+	{
+		std::vector<HalfBandUpsampler<SampleType>>().swap(m_upsamplers[stage]);
+		std::vector<HalfBandDownsampler<SampleType>>().swap(m_downsamplers[stage]);
+	}
+
+	std::vector<SampleType>().swap(m_buffers);
+	std::vector<SampleType*>().swap(m_pointers);
+	m_bufferSize = 0;
+}
+
+template <typename SampleType>
+inline void Oversampler<SampleType>::reset()
+{
+	for (int stage = 0; stage < maxFactorLog2; ++stage)
+	{
+		for (auto& upsampler : m_upsamplers[stage])
+		{
+			upsampler.reset();
+		}
+
+		for (auto& downsampler : m_downsamplers[stage])
+		{
+			downsampler.reset();
+		}
+	}
+}
+
+template <typename SampleType>
+inline void Oversampler<SampleType>::setFactorLog2(int factorLog2)
+{
+	m_factorLog2 = factorLog2 < 0 ? 0 : (factorLog2 > maxFactorLog2 ? maxFactorLog2 : factorLog2);
+	reset();
+}
+
+template <typename SampleType>
+inline float Oversampler<SampleType>::getLatency(int factorLog2) const
+{
+	float latency = 0.0f;
+
+	for (int stage = 0; stage < std::min(factorLog2, (int)maxFactorLog2); ++stage)
+	{
+		latency += (float)m_coefs[stage].getCentre() / (float)(1 << stage);
+	}
+
+	return latency;
+}
+
+template <typename SampleType>
+inline SampleType* const* Oversampler<SampleType>::upsample(const SampleType* const* channels, int numChannels, int samples)
+{
+	for (int channel = 0; channel < numChannels; ++channel)
+	{
+		SampleType* ping = m_buffers.data() + (2 * channel) * m_bufferSize;
+		SampleType* pong = ping + m_bufferSize;
+
+		const SampleType* in = channels[channel];
+		int stageSamples = samples;
+
+		for (int stage = 0; stage < m_factorLog2; ++stage)
+		{
+			SampleType* out = (stage % 2 == 0) ? ping : pong;
+			m_upsamplers[stage][channel].process(in, out, stageSamples);
+
+			in = out;
+			stageSamples *= 2;
+		}
+
+		m_pointers[channel] = const_cast<SampleType*>(in);
+	}
+
+	return m_pointers.data();
+}
+
+template <typename SampleType>
+inline void Oversampler<SampleType>::downsample(SampleType* const* channels, int numChannels, int samples)
+{
+	for (int channel = 0; channel < numChannels; ++channel)
+	{
+		SampleType* ping = m_buffers.data() + (2 * channel) * m_bufferSize;
+		SampleType* pong = ping + m_bufferSize;
+
+		const SampleType* in = m_pointers[channel];
+
+		for (int stage = m_factorLog2 - 1; stage >= 0; --stage)
+		{
+			SampleType* out = (stage == 0) ? channels[channel] : (in == ping ? pong : ping);
+			m_downsamplers[stage][channel].process(in, out, samples << stage);
+
+			in = out;
+		}
+	}
+}
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    ParameterSmoother.h
+    Block based parameter ramp. The target is set once per block, the kernel
+    gets a start value, a per sample step and the number of samples the ramp
+    still runs for, and only takes its ramped path while that is non-zero.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FastMath.h"
+
+//==============================================================================
+class ParameterSmoother
+{
+public:
+	enum class Type
+	{
+		Linear,
+		Multiplicative		// Constant dB per sample, values have to be > 0
+	};
+
+	struct Ramp
+	{
+		float start = 0.0f;
+		float step = 0.0f;		// Added per sample (Linear) or multiplied (Multiplicative)
+		int samples = 0;
+	};
+
+	void init(Type type, int rampSamples);
+	void reset(float value);
+	void setTarget(float target);
+
+	bool isSmoothing() const { return m_countdown > 0; };
+	float getCurrent() const { return m_current; };
+
+	// Ramp for the next block of 'samples', advances the smoother past it
+	Ramp advance(int samples);
+
+protected:
+	Type m_type = Type::Linear;
+	int m_rampSamples = 1;
+
+	float m_current = 0.0f;
+	float m_start = 0.0f;
+	float m_target = 0.0f;
+	float m_step = 0.0f;
+	int m_countdown = 0;
+};
+
+inline void ParameterSmoother::init(Type type, int rampSamples)
+{
+	m_type = type;
+	m_rampSamples = rampSamples > 1 ? rampSamples : 1;
+}
+
+inline void ParameterSmoother::reset(float value)
+{
+	m_current = value;
+	m_target = value;
+	m_step = m_type == Type::Linear ? 0.0f : 1.0f;
+	m_countdown = 0;
+}
+
+inline void ParameterSmoother::setTarget(float target)
+{
+	if (target == m_target)
+	{
+		return;
+	}
+
+	m_target = target;
+	m_start = m_current;
+	m_countdown = m_rampSamples;
+
+	if (m_type == Type::Linear)
+	{
+		m_step = (m_target - m_current) / (float)m_rampSamples;
+	}
+	else
+	{
+		m_step = HarmonicsMath::pow(m_target / m_current, 1.0f / (float)m_rampSamples);
+	}
+}
+
+inline ParameterSmoother::Ramp ParameterSmoother::advance(int samples)
+{
+	Ramp ramp;
+	ramp.start = m_current;
+	ramp.step = m_step;
+	ramp.samples = m_countdown < samples ? m_countdown : samples;
+
+	if (ramp.samples == 0)
+	{
+		return ramp;
+	}
+
+	m_countdown -= ramp.samples;
+
+	// From the start of the ramp, so the value does not depend on how the ramp was split into blocks
+	if (m_countdown == 0)
+	{
+		m_current = m_target;
+	}
+	else if (m_type == Type::Linear)
+	{
+		m_current = m_start + m_step * (float)(m_rampSamples - m_countdown);
+	}
+	else
+	{
+		m_current = m_start * HarmonicsMath::pow(m_step, (float)(m_rampSamples - m_countdown));
+	}
+
+	return ramp;
+}
@@ -16,12 +16,15 @@ const juce::Colour HarmonicsAudioProcessorEditor::dark       = juce::Colour::fro
 
 //==============================================================================
 HarmonicsAudioProcessorEditor::HarmonicsAudioProcessorEditor (HarmonicsAudioProcessor& p, juce::AudioProcessorValueTreeState& vts)
-    : AudioProcessorEditor (&p), audioProcessor (p), valueTreeState(vts)
+    : AudioProcessorEditor (&p), audioProcessor (p), valueTreeState(vts), analyzer(p.getAnalysis())
 {
 	getLookAndFeel().setColour(juce::Slider::thumbColourId, dark);
 	getLookAndFeel().setColour(juce::Slider::rotarySliderFillColourId, medium);
 	getLookAndFeel().setColour(juce::Slider::rotarySliderOutlineColourId, light);
 
+	// Everything is painted here, the host never has to draw behind it
+	setOpaque(true);
+
 	for (int i = 0; i < N_SLIDERS_COUNT; i++)
 	{
 		auto& label = m_labels[i];
@@ -36,6 +39,7 @@ HarmonicsAudioProcessorEditor::HarmonicsAudioProcessorEditor (HarmonicsAudioProc
 		//Slider
 		slider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
 		slider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+		slider.setBufferedToImage(true);
 		addAndMakeVisible(slider);
 		m_sliderAttachment[i].reset(new SliderAttachment(valueTreeState, HarmonicsAudioProcessor::paramsNames[i], slider));
 	}
@@ -56,6 +60,75 @@ HarmonicsAudioProcessorEditor::HarmonicsAudioProcessorEditor (HarmonicsAudioProc
 	button6Attachment.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(valueTreeState, "Button6", harmonics6Button));
 	button8Attachment.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(valueTreeState, "Button8", harmonics8Button));
 
+	// Presets
+	for (int program = 0; program < audioProcessor.getNumPrograms(); ++program)
+	{
+		presetComboBox.addItem(audioProcessor.getProgramName(program), program + 1);
+	}
+
+	presetComboBox.setSelectedId(audioProcessor.getCurrentProgram() + 1, juce::dontSendNotification);
+	presetComboBox.onChange = [this] { audioProcessor.setCurrentProgram(presetComboBox.getSelectedId() - 1); };
+	addAndMakeVisible(presetComboBox);
+
+	// Mid/side
+	modeComboBox.addItemList(HarmonicsAudioProcessor::modeNames, 1);
+	addAndMakeVisible(modeComboBox);
+	modeAttachment.reset(new ComboBoxAttachment(valueTreeState, "Mode", modeComboBox));
+
+	for (int i = 0; i < 4; i++)
+	{
+		sideButtons[i].setClickingTogglesState(true);
+		addAndMakeVisible(sideButtons[i]);
+		sideButtonAttachments[i].reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(valueTreeState, "SideButton" + juce::String(2 * i + 2), sideButtons[i]));
+	}
+
+	// Envelope
+	envelopeButton.setClickingTogglesState(true);
+	addAndMakeVisible(envelopeButton);
+	envelopeAttachment.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(valueTreeState, "Envelope", envelopeButton));
+
+	sidechainButton.setClickingTogglesState(true);
+	addAndMakeVisible(sidechainButton);
+	sidechainAttachment.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(valueTreeState, "Sidechain", sidechainButton));
+
+	// Oversampling
+	oversamplingComboBox.addItemList(HarmonicsAudioProcessor::oversamplingNames, 1);
+	addAndMakeVisible(oversamplingComboBox);
+	oversamplingAttachment.reset(new ComboBoxAttachment(valueTreeState, "Oversampling", oversamplingComboBox));
+
+	// Engine
+	engineComboBox.addItemList(HarmonicsAudioProcessor::engineNames, 1);
+	addAndMakeVisible(engineComboBox);
+	engineAttachment.reset(new ComboBoxAttachment(valueTreeState, "Engine", engineComboBox));
+
+	// Limiter
+	limiterButton.setClickingTogglesState(true);
+	addAndMakeVisible(limiterButton);
+	limiterAttachment.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(valueTreeState, "Limiter", limiterButton));
+
+	lookaheadComboBox.addItemList(HarmonicsAudioProcessor::lookaheadNames, 1);
+	addAndMakeVisible(lookaheadComboBox);
+	lookaheadAttachment.reset(new ComboBoxAttachment(valueTreeState, "Lookahead", lookaheadComboBox));
+
+	// Chebyshev levels
+	for (int i = 0; i < N_LEVEL_SLIDERS_COUNT; i++)
+	{
+		const int harmonic = i + 2;
+		auto& label = m_levelLabels[i];
+		auto& slider = m_levelSliders[i];
+
+		label.setText(juce::String(harmonic), juce::dontSendNotification);
+		label.setFont(juce::Font(14.0f * 0.01f * SCALE));
+		label.setJustificationType(juce::Justification::centred);
+		addAndMakeVisible(label);
+
+		slider.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
+		slider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+		slider.setBufferedToImage(true);
+		addAndMakeVisible(slider);
+		m_levelAttachments[i].reset(new SliderAttachment(valueTreeState, HarmonicsAudioProcessor::getHarmonicParameterID(harmonic), slider));
+	}
+
 	/*harmonics2Button.setColour(juce::TextButton::buttonColourId, light);
 	harmonics4Button.setColour(juce::TextButton::buttonColourId, light);
 	harmonics6Button.setColour(juce::TextButton::buttonColourId, light);
@@ -66,7 +139,16 @@ HarmonicsAudioProcessorEditor::HarmonicsAudioProcessorEditor (HarmonicsAudioProc
 	harmonics6Button.setColour(juce::TextButton::buttonOnColourId, dark);
 	harmonics8Button.setColour(juce::TextButton::buttonOnColourId, dark);*/
 
-	setSize((int)(SLIDER_WIDTH * 0.01f * SCALE * N_SLIDERS_COUNT), (int)((SLIDER_WIDTH + BOTTOM_MENU_HEIGHT) * 0.01f * SCALE));
+	// Meters and spectrum
+	addAndMakeVisible(analyzer);
+
+	statusLabel.setFont(juce::Font(14.0f * 0.01f * SCALE));
+	statusLabel.setJustificationType(juce::Justification::centred);
+	addAndMakeVisible(statusLabel);
+
+	setSize((int)(SLIDER_WIDTH * 0.01f * SCALE * N_SLIDERS_COUNT), (int)((SLIDER_WIDTH + BOTTOM_MENU_HEIGHT + LEVELS_HEIGHT + STATUS_HEIGHT + ANALYZER_HEIGHT) * 0.01f * SCALE));
+
+	updateStatus();
 }
 
 HarmonicsAudioProcessorEditor::~HarmonicsAudioProcessorEditor()
@@ -78,6 +160,27 @@ void HarmonicsAudioProcessorEditor::paint (juce::Graphics& g)
 	g.fillAll(veryLight);
 }
 
+void HarmonicsAudioProcessorEditor::updateStatus()
+{
+	const double sampleRate = audioProcessor.getSampleRate();
+	const double latencyMs = sampleRate > 0.0 ? 1000.0 * audioProcessor.getLatencySamples() / sampleRate : 0.0;
+
+	juce::String text = "Latency " + juce::String(latencyMs, 2) + " ms";
+
+	ProcessProfiler::Stats stats;
+
+	if (audioProcessor.getProfiler().getStats(stats))
+	{
+		text += "   Block avg " + juce::String(stats.averageMicroseconds, 1) + " us, p99 " + juce::String(stats.p99Microseconds, 1)
+			+ " us, max " + juce::String(stats.maxMicroseconds, 1) + " us"
+			+ "   CPU avg " + juce::String(100.0 * stats.averageLoad, 1) + "%, p99 " + juce::String(100.0 * stats.p99Load, 1)
+			+ "%, max " + juce::String(100.0 * stats.maxLoad, 1) + "%"
+			+ "   Overloads " + juce::String((juce::int64)stats.overloads);
+	}
+
+	statusLabel.setText(text, juce::dontSendNotification);
+}
+
 void HarmonicsAudioProcessorEditor::resized()
 {
 	// Sliders + Menus
@@ -104,4 +207,39 @@ void HarmonicsAudioProcessorEditor::resized()
 	harmonics4Button.setBounds((int)(center - buttonHeight * 1.2f), posY, buttonHeight, buttonHeight);
 	harmonics6Button.setBounds((int)(center + buttonHeight * 0.0f), posY, buttonHeight, buttonHeight);
 	harmonics8Button.setBounds((int)(center + buttonHeight * 1.2f), posY, buttonHeight, buttonHeight);
+
+	oversamplingComboBox.setBounds((int)(center + buttonHeight * 3.0f), posY, (int)(buttonHeight * 2.4f), buttonHeight);
+	presetComboBox.setBounds((int)(center - buttonHeight * 14.0f), posY, (int)(buttonHeight * 7.0f), buttonHeight);
+	engineComboBox.setBounds((int)(center - buttonHeight * 6.6f), posY, (int)(buttonHeight * 3.6f), buttonHeight);
+	limiterButton.setBounds((int)(center + buttonHeight * 6.0f), posY, (int)(buttonHeight * 2.4f), buttonHeight);
+	lookaheadComboBox.setBounds((int)(center + buttonHeight * 8.6f), posY, (int)(buttonHeight * 3.6f), buttonHeight);
+
+	modeComboBox.setBounds((int)(center - buttonHeight * 19.0f), posY, (int)(buttonHeight * 4.6f), buttonHeight);
+
+	for (int i = 0; i < 4; i++)
+	{
+		sideButtons[i].setBounds((int)(center + buttonHeight * (13.0f + 1.6f * i)), posY, (int)(buttonHeight * 1.4f), buttonHeight);
+	}
+
+	envelopeButton.setBounds((int)(center + buttonHeight * 20.0f), posY, (int)(buttonHeight * 2.4f), buttonHeight);
+	sidechainButton.setBounds((int)(center + buttonHeight * 22.6f), posY, (int)(buttonHeight * 2.4f), buttonHeight);
+
+	// Levels
+	const int levelsY = height + (int)(BOTTOM_MENU_HEIGHT * 0.01f * SCALE);
+	const int levelsHeight = (int)(LEVELS_HEIGHT * 0.01f * SCALE);
+	const int levelLabelHeight = (int)(LABEL_OFFSET * 0.01f * SCALE);
+	const int levelWidth = getWidth() / N_LEVEL_SLIDERS_COUNT;
+
+	for (int i = 0; i < N_LEVEL_SLIDERS_COUNT; ++i)
+	{
+		m_levelSliders[i].setBounds(i * levelWidth, levelsY, levelWidth, levelsHeight - levelLabelHeight);
+		m_levelLabels[i].setBounds(i * levelWidth, levelsY + levelsHeight - levelLabelHeight, levelWidth, levelLabelHeight);
+	}
+
+	// Status and analyzer
+	const int statusHeight = (int)(STATUS_HEIGHT * 0.01f * SCALE);
+	statusLabel.setBounds(0, levelsY + levelsHeight, getWidth(), statusHeight);
+
+	const int analyzerHeight = (int)(ANALYZER_HEIGHT * 0.01f * SCALE);
+	analyzer.setBounds(0, getHeight() - analyzerHeight, getWidth(), analyzerHeight);
 }
\ No newline at end of file
@@ -10,6 +10,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "AnalyzerComponent.h"
+#include "FrameClock.h"
 
 //==============================================================================
 class HarmonicsAudioProcessorEditor : public juce::AudioProcessorEditor
@@ -19,11 +21,18 @@ public:
     ~HarmonicsAudioProcessorEditor() override;
 
 	// GUI setup
-	static const int N_SLIDERS_COUNT = 3;
+	static const int N_SLIDERS_COUNT = 10;
 	static const int SCALE = 70;
 	static const int LABEL_OFFSET = 25;
 	static const int SLIDER_WIDTH = 200;
 	static const int BOTTOM_MENU_HEIGHT = 50;
+	static const int LEVELS_HEIGHT = 100;
+	static const int ANALYZER_HEIGHT = 200;
+	static const int STATUS_HEIGHT = 30;
+	static const int STATUS_RATE = 4;
+
+	// Chebyshev engine, harmonics 2 ... 16
+	static const int N_LEVEL_SLIDERS_COUNT = ChebyshevLevels::maxHarmonic - 1;
 	static const int HUE = 75;
 
 	static const int TYPE_BUTTON_GROUP = 1;
@@ -42,6 +51,8 @@ public:
 	typedef juce::AudioProcessorValueTreeState::ComboBoxAttachment ComboBoxAttachment;
 
 private:
+	void updateStatus();
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     HarmonicsAudioProcessor& audioProcessor;
@@ -66,5 +77,43 @@ private:
 	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> button6Attachment;
 	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> button8Attachment;
 
+	// Mid/side, the side buttons next to the limiter
+	juce::ComboBox modeComboBox;
+	std::unique_ptr<ComboBoxAttachment> modeAttachment;
+
+	juce::TextButton sideButtons[4]{ { "S2" }, { "S4" }, { "S6" }, { "S8" } };
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> sideButtonAttachments[4];
+
+	juce::ComboBox presetComboBox;
+
+	// Envelope follower, Key switches it to the sidechain
+	juce::TextButton envelopeButton{ "Env" };
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> envelopeAttachment;
+
+	juce::TextButton sidechainButton{ "Key" };
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> sidechainAttachment;
+
+	juce::ComboBox oversamplingComboBox;
+	std::unique_ptr<ComboBoxAttachment> oversamplingAttachment;
+
+	juce::ComboBox engineComboBox;
+	std::unique_ptr<ComboBoxAttachment> engineAttachment;
+
+	juce::TextButton limiterButton{ "Limit" };
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> limiterAttachment;
+
+	juce::ComboBox lookaheadComboBox;
+	std::unique_ptr<ComboBoxAttachment> lookaheadAttachment;
+
+	juce::Label m_levelLabels[N_LEVEL_SLIDERS_COUNT] = {};
+	juce::Slider m_levelSliders[N_LEVEL_SLIDERS_COUNT] = {};
+	std::unique_ptr<SliderAttachment> m_levelAttachments[N_LEVEL_SLIDERS_COUNT] = {};
+
+	AnalyzerComponent analyzer;
+
+	// processBlock timing and latency
+	juce::Label statusLabel;
+	FrameClock statusClock{ *this, STATUS_RATE, [this] { updateStatus(); } };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HarmonicsAudioProcessorEditor)
 };
@@ -7,59 +7,22 @@
 */
 
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
+#include "PresetBank.h"
 
-//==============================================================================
-SecondOrderHighPass::SecondOrderHighPass()
-{
-}
-
-void SecondOrderHighPass::init(int sampleRate)
-{
-	m_sampleRate = sampleRate;
-}
-
-void SecondOrderHighPass::setCoef(float frequency, float Q)
-{
-	if (m_sampleRate == 0)
-	{
-		return;
-	}
-
-	const float omega = frequency * (2.0f * 3.141593f / m_sampleRate);
-	const float alpha = sinf(omega) / (2.0f * Q);
-	const float cn = cosf(omega);
-
-	m_a0 = 1.0f + alpha;
-	m_a1 = -2.0f * cn;
-	m_a2 = 1.0f - alpha;
-
-	m_b0 = (1 + cn) / 2.0f;
-	m_b1 = -1.0f * (1.0f + cn);
-	m_b2 = m_b0;
-
-	m_a1 /= m_a0;
-	m_a2 /= m_a0;
-
-	m_b0 /= m_a0;
-	m_b1 /= m_a0;
-	m_b2 /= m_a0;
-}
-
-float SecondOrderHighPass::process(float in)
-{
-	float y = m_b0 * in + m_b1 * m_x1 + m_b2 * m_x2 - m_a1 * m_y1 - m_a2 * m_y2;
-
-	m_y2 = m_y1;
-	m_y1 = y;
-	m_x2 = m_x1;
-	m_x1 = in;
+// Offline tools build the processor with HARMONICS_HEADLESS=1 and without the editor
+#if ! HARMONICS_HEADLESS
+ #include "PluginEditor.h"
+#endif
 
-	return y;
-}
 //==============================================================================
 
-const std::string HarmonicsAudioProcessor::paramsNames[] = { "Gain", "Mix", "Volume" };
+const std::string HarmonicsAudioProcessor::paramsNames[] = { "Gain", "Mix", "Volume", "Cutoff", "Q", "SideGain", "SideMix", "Depth", "Attack", "Release" };
+const juce::StringArray HarmonicsAudioProcessor::oversamplingNames = { "1x", "2x", "4x", "8x" };
+const juce::StringArray HarmonicsAudioProcessor::engineNames = { "Classic", "Chebyshev" };
+const juce::StringArray HarmonicsAudioProcessor::modeNames = { "Stereo", "Mid/Side" };
+const juce::StringArray HarmonicsAudioProcessor::lookaheadNames = { "0.5 ms", "1 ms", "2 ms", "5 ms" };
+const float HarmonicsAudioProcessor::lookaheadTimes[] = { 0.0005f, 0.001f, 0.002f, 0.005f };
+const char* const HarmonicsAudioProcessor::latencyParameterIDs[] = { "Oversampling", "Limiter", "Lookahead" };
 
 //==============================================================================
 HarmonicsAudioProcessor::HarmonicsAudioProcessor()
@@ -68,6 +31,7 @@ HarmonicsAudioProcessor::HarmonicsAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -77,15 +41,100 @@ HarmonicsAudioProcessor::HarmonicsAudioProcessor()
 	gainParameter   = apvts.getRawParameterValue(paramsNames[0]);
 	mixParameter    = apvts.getRawParameterValue(paramsNames[1]);
 	volumeParameter = apvts.getRawParameterValue(paramsNames[2]);
+	cutoffParameter = apvts.getRawParameterValue(paramsNames[3]);
+	qParameter      = apvts.getRawParameterValue(paramsNames[4]);
+	sideGainParameter = apvts.getRawParameterValue(paramsNames[5]);
+	sideMixParameter  = apvts.getRawParameterValue(paramsNames[6]);
+	depthParameter    = apvts.getRawParameterValue(paramsNames[7]);
+	attackParameter   = apvts.getRawParameterValue(paramsNames[8]);
+	releaseParameter  = apvts.getRawParameterValue(paramsNames[9]);
 
 	button2Parameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("Button2"));
 	button4Parameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("Button4"));
 	button6Parameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("Button6"));
 	button8Parameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("Button8"));
+
+	modeParameter = static_cast<juce::AudioParameterChoice*>(apvts.getParameter("Mode"));
+	sideButton2Parameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("SideButton2"));
+	sideButton4Parameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("SideButton4"));
+	sideButton6Parameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("SideButton6"));
+	sideButton8Parameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("SideButton8"));
+
+	oversamplingParameter = static_cast<juce::AudioParameterChoice*>(apvts.getParameter("Oversampling"));
+	engineParameter = static_cast<juce::AudioParameterChoice*>(apvts.getParameter("Engine"));
+	limiterParameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("Limiter"));
+	lookaheadParameter = static_cast<juce::AudioParameterChoice*>(apvts.getParameter("Lookahead"));
+	envelopeParameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("Envelope"));
+	sidechainParameter = static_cast<juce::AudioParameterBool*>(apvts.getParameter("Sidechain"));
+
+	for (int harmonic = 2; harmonic <= ChebyshevLevels::maxHarmonic; ++harmonic)
+	{
+		harmonicParameters[harmonic] = apvts.getRawParameterValue(getHarmonicParameterID(harmonic));
+	}
+
+	for (const auto* id : latencyParameterIDs)
+	{
+		apvts.addParameterListener(id, this);
+	}
+
+	// Parameter table for the binary state, hashes must stay unique
+	for (auto* parameter : getParameters())
+	{
+		auto* ranged = static_cast<juce::RangedAudioParameter*>(parameter);
+		const auto hash = hashParameterID(ranged->paramID);
+
+		jassert(std::find(m_parameterHashes.begin(), m_parameterHashes.end(), hash) == m_parameterHashes.end());
+
+		m_parameters.push_back(ranged);
+		m_parameterHashes.push_back(hash);
+	}
+
+	const int numParameters = (int)m_parameters.size();
+	m_stateValues.resize(numParameters);
+
+	// Presets, parameters a preset leaves out get their default
+	m_presetValues.resize((size_t)PresetBank::NUM_PRESETS * numParameters);
+
+	for (int preset = 0; preset < PresetBank::NUM_PRESETS; ++preset)
+	{
+		float* values = m_presetValues.data() + (size_t)preset * numParameters;
+
+		for (int index = 0; index < numParameters; ++index)
+		{
+			values[index] = m_parameters[index]->getDefaultValue();
+		}
+
+		for (const auto& value : PresetBank::presets[preset].values)
+		{
+			if (value.id == nullptr)
+			{
+				break;
+			}
+
+			const auto hash = hashParameterID(value.id);
+			const auto found = std::find(m_parameterHashes.begin(), m_parameterHashes.end(), hash);
+			jassert(found != m_parameterHashes.end());
+
+			if (found != m_parameterHashes.end())
+			{
+				const int index = (int)(found - m_parameterHashes.begin());
+				values[index] = m_parameters[index]->convertTo0to1(value.value);
+			}
+		}
+	}
+
+	readParameterValues();
 }
 
 HarmonicsAudioProcessor::~HarmonicsAudioProcessor()
 {
+	for (const auto* id : latencyParameterIDs)
+	{
+		apvts.removeParameterListener(id, this);
+	}
+
+	cancelPendingUpdate();
+	updateWorkerPool(false);
 }
 
 //==============================================================================
@@ -123,27 +172,39 @@ bool HarmonicsAudioProcessor::isMidiEffect() const
 
 double HarmonicsAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+	// Filter ring-out after the input stops, lets hosts suspend idle instances
+	return TAIL_TIME;
 }
 
 int HarmonicsAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+	return PresetBank::NUM_PRESETS;
 }
 
 int HarmonicsAudioProcessor::getCurrentProgram()
 {
-    return 0;
+	return m_currentProgram;
 }
 
 void HarmonicsAudioProcessor::setCurrentProgram (int index)
 {
+	if (index < 0 || index >= PresetBank::NUM_PRESETS)
+	{
+		return;
+	}
+
+	m_currentProgram = index;
+	applyParameterValues(m_presetValues.data() + (size_t)index * m_parameters.size());
 }
 
 const juce::String HarmonicsAudioProcessor::getProgramName (int index)
 {
-    return {};
+	if (index < 0 || index >= PresetBank::NUM_PRESETS)
+	{
+		return {};
+	}
+
+	return PresetBank::presets[index].name;
 }
 
 void HarmonicsAudioProcessor::changeProgramName (int index, const juce::String& newName)
@@ -153,31 +214,76 @@ void HarmonicsAudioProcessor::changeProgramName (int index, const juce::String&
 //==============================================================================
 void HarmonicsAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-	m_secondOrderHighPass2[0].init((int)sampleRate);
-	m_secondOrderHighPass2[1].init((int)sampleRate);
-	m_secondOrderHighPass4[0].init((int)sampleRate);
-	m_secondOrderHighPass4[1].init((int)sampleRate);
-	m_secondOrderHighPass6[0].init((int)sampleRate);
-	m_secondOrderHighPass6[1].init((int)sampleRate);
-	m_secondOrderHighPass8[0].init((int)sampleRate);
-	m_secondOrderHighPass8[1].init((int)sampleRate);
+	const int numChannels = juce::jmin(getTotalNumOutputChannels(), MAX_CHANNELS);
+	const float maxLookahead = lookaheadTimes[lookaheadNames.size() - 1];
+
+	readParameterValues();
+
+	// All channel state is allocated here, processBlock never allocates.
+	// Only the precision the host processes in gets buffers
+	auto prepare = [this, sampleRate, samplesPerBlock, numChannels, maxLookahead](auto& core, bool inUse)
+	{
+		if (inUse)
+		{
+			core.setSettings(m_values);
+			core.prepare(sampleRate, numChannels, samplesPerBlock, maxLookahead);
+		}
+		else
+		{
+			core.release();
+		}
+	};
+
+	prepare(m_floatCore, ! isUsingDoublePrecision());
+	prepare(m_doubleCore, isUsingDoublePrecision());
+	updateLatency();
 
-	const float frequency = 20.0f;
-	const float Q = 0.7f;
+	// Workers only run while some instance has more than one channel group to give them
+	updateWorkerPool(m_parallelProcessing && (m_floatCore.getNumGroups() > 1 || m_doubleCore.getNumGroups() > 1));
 
-	m_secondOrderHighPass2[0].setCoef(frequency, Q);
-	m_secondOrderHighPass2[1].setCoef(frequency, Q);
-	m_secondOrderHighPass4[0].setCoef(frequency, Q);
-	m_secondOrderHighPass4[1].setCoef(frequency, Q);
-	m_secondOrderHighPass6[0].setCoef(frequency, Q);
-	m_secondOrderHighPass6[1].setCoef(frequency, Q);
-	m_secondOrderHighPass8[0].setCoef(frequency, Q);
-	m_secondOrderHighPass8[1].setCoef(frequency, Q);
+	// Analysis runs on the host rate output
+	m_analysis.setSampleRate(sampleRate);
+	m_profiler.prepare(sampleRate);
+}
+
+bool HarmonicsAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+	return true;
 }
 
 void HarmonicsAudioProcessor::releaseResources()
 {
-	
+	updateWorkerPool(false);
+}
+
+void HarmonicsAudioProcessor::setParallelProcessing(bool enabled)
+{
+	m_parallelProcessing = enabled;
+
+	if (! enabled)
+	{
+		updateWorkerPool(false);
+	}
+}
+
+void HarmonicsAudioProcessor::updateWorkerPool(bool inUse)
+{
+	if (inUse == m_usingWorkerPool.load())
+	{
+		return;
+	}
+
+	// The audio thread stops asking before the workers go, a job already running finishes first
+	if (inUse)
+	{
+		m_workerPool->addUser();
+		m_usingWorkerPool.store(true);
+	}
+	else
+	{
+		m_usingWorkerPool.store(false);
+		m_workerPool->removeUser();
+	}
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -187,18 +293,20 @@ bool HarmonicsAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Channels are processed independently, so any layout works, surround and ambisonics included
+    const int channels = layouts.getMainOutputChannelSet().size();
+
+    if (channels < 1 || channels > MAX_CHANNELS)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // Sidechain may be off or any size, missing channels repeat its last one
+    if (layouts.inputBuses.size() > SIDECHAIN_BUS && layouts.getChannelSet(true, SIDECHAIN_BUS).size() > MAX_CHANNELS)
+        return false;
    #endif
 
     return true;
@@ -208,90 +316,336 @@ bool HarmonicsAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 
 void HarmonicsAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-	// Get params
-	const auto gain = juce::Decibels::decibelsToGain(gainParameter->load());
-	const auto mix = mixParameter->load();
-	const auto volume = juce::Decibels::decibelsToGain(volumeParameter->load());
+	process(buffer);
+}
 
-	// Buttons
-	const auto button2 = button2Parameter->get();
-	const auto button4 = button4Parameter->get();
-	const auto button6 = button6Parameter->get();
-	const auto button8 = button8Parameter->get();
+void HarmonicsAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+	process(buffer);
+}
 
-	// Gains
-	const float gain2 = 2.0f;
-	const float gain4 = 8.0f;
-	const float gain6 = 16.0f;
-	const float gain8 = 24.0f;
+template <typename SampleType>
+void HarmonicsAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer)
+{
+	// Whole block including the silent path and the analysis
+	ProcessProfiler::Scope profilerScope(m_profiler, buffer.getNumSamples());
 
-	// Mics constants
-	const float mixInverse = 1.0f - mix;
-	const int channels = getTotalNumOutputChannels();
-	const int samples = buffer.getNumSamples();		
+	// Decaying filter state must not turn into denormals
+	juce::ScopedNoDenormals noDenormals;
 
-	for (int channel = 0; channel < channels; ++channel)
-	{
-		// Channel pointer
-		auto* channelBuffer = buffer.getWritePointer(channel);
+	// All parameters of this block at once, a preset being applied shows up complete in a later block.
+	// The host gives no positions within the block, so automation is still quantised to host blocks:
+	// a new target lands on the first sample of the block it is read in, and renders with other
+	// buffer sizes differ. The core's grid of sub-blocks only keeps the ramps themselves independent
+	// of the block size, sample-accurate changes need the core's HarmonicsSettingsChange overload
+	readParameterValues();
+
+	// Oversampling and limiter changes restart their state, the latency is reported by updateLatency()
+	auto& core = getCore(buffer);
+	core.setSettings(m_values);
 
-		auto& secondOrderHighPass2 = m_secondOrderHighPass2[channel];
-		auto& secondOrderHighPass4 = m_secondOrderHighPass4[channel];
-		auto& secondOrderHighPass6 = m_secondOrderHighPass6[channel];
-		auto& secondOrderHighPass8 = m_secondOrderHighPass8[channel];
+	const int channels = juce::jmin(core.getNumChannels(), buffer.getNumChannels());
+	const int samples = buffer.getNumSamples();
 
-		for (int sample = 0; sample < samples; ++sample)
+	// Metered kernel variants only run while the editor shows the analysis or a tool sums the levels
+	const bool analysing = m_analysis.isEnabled();
+	const bool metering = analysing || m_offlineMetering;
+	HarmonicsMeter meter;
+
+	// Sidechain key, a channel per processed channel
+	const SampleType* sidechainBuffers[MAX_CHANNELS] = {};
+	const int sidechainChannels = m_values.envelope && m_values.sidechain && getBusCount(true) > SIDECHAIN_BUS ? getChannelCountOfBus(true, SIDECHAIN_BUS) : 0;
+
+	if (sidechainChannels > 0)
+	{
+		const int firstChannel = getChannelIndexInProcessBlockBuffer(true, SIDECHAIN_BUS, 0);
+
+		for (int channel = 0; channel < channels; ++channel)
 		{
-			// Get input
-			const float in = channelBuffer[sample] * gain;
+			sidechainBuffers[channel] = buffer.getReadPointer(firstChannel + juce::jmin(channel, sidechainChannels - 1));
+		}
+	}
 
-			const float inDist2 = in * in * gain2;
-			const float inFilter2 = secondOrderHighPass2.process(inDist2);
+	auto runGroups = [this](int numGroups, int kernelSamples, auto& processGroup)
+	{
+		return m_usingWorkerPool.load() && numGroups > 1 && kernelSamples >= PARALLEL_MIN_SAMPLES && m_workerPool->run(numGroups, processGroup);
+	};
 
-			const float inDist4 = inFilter2 * inFilter2 * gain4;
-			const float inFilter4 = secondOrderHighPass4.process(inDist4);
+	const bool processed = core.process(buffer.getArrayOfWritePointers(), sidechainChannels > 0 ? sidechainBuffers : nullptr, channels, samples,
+		metering ? &meter : nullptr, isInputSilent(buffer, channels, samples), runGroups);
 
-			const float inDist6 = inFilter2 * inFilter4 * gain6;
-			const float inFilter6 = secondOrderHighPass6.process(inDist6);
+	// Silent output, a cleared buffer is flagged as silent for the wrapper
+	if (! processed)
+	{
+		buffer.clear();
+	}
+
+	// Meters fall to zero while silent
+	if (analysing)
+	{
+		m_analysis.pushLevels(meter);
+		m_analysis.pushScope(buffer.getArrayOfReadPointers(), channels, samples);
+	}
 
-			const float inDist8 = inFilter4 * inFilter4 * gain8;
-			const float inFilter8 = secondOrderHighPass8.process(inDist8);
+	if (m_offlineMetering)
+	{
+		m_offlineMeter.add(meter);
+	}
+}
 
-			const float inDist = button2 * inFilter2 + button4 * inFilter4 + button6 * inFilter6 + button8 * inFilter8;
-			const float inLimit = fmaxf(-1.0f, fminf(1.0f, inDist));
+template <typename SampleType>
+bool HarmonicsAudioProcessor::isInputSilent(const juce::AudioBuffer<SampleType>& buffer, int channels, int samples) const
+{
+	if (buffer.hasBeenCleared())
+	{
+		return true;
+	}
 
-			// Apply volume, mix and send to output
-			channelBuffer[sample] = volume * (mix * inLimit + mixInverse * in);
+	for (int channel = 0; channel < channels; ++channel)
+	{
+		if (buffer.getMagnitude(channel, 0, samples) != SampleType(0))
+		{
+			return false;
 		}
 	}
+
+	return true;
 }
 
 //==============================================================================
 bool HarmonicsAudioProcessor::hasEditor() const
 {
+   #if HARMONICS_HEADLESS
+    return false;
+   #else
     return true; // (change this to false if you choose to not supply an editor)
+   #endif
 }
 
 juce::AudioProcessorEditor* HarmonicsAudioProcessor::createEditor()
 {
+   #if HARMONICS_HEADLESS
+    return nullptr;
+   #else
     return new HarmonicsAudioProcessorEditor (*this, apvts);
+   #endif
 }
 
 //==============================================================================
 void HarmonicsAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {	
-	auto state = apvts.copyState();
-	std::unique_ptr<juce::XmlElement> xml(state.createXml());
-	copyXmlToBinary(*xml, destData);
+	// Binary, read straight from the parameters without going through the value tree
+	const int numParameters = (int)m_parameters.size();
+	destData.setSize((size_t)(STATE_HEADER_SIZE + numParameters * STATE_ENTRY_SIZE));
+
+	auto* bytes = static_cast<char*>(destData.getData());
+
+	juce::ByteOrder::writeLittleEndianInt(bytes, STATE_MAGIC);
+	juce::ByteOrder::writeLittleEndianShort(bytes + 4, (juce::uint16)STATE_VERSION);
+	juce::ByteOrder::writeLittleEndianShort(bytes + 6, (juce::uint16)numParameters);
+	juce::ByteOrder::writeLittleEndianInt(bytes + 8, (juce::uint32)m_currentProgram);
+	bytes += STATE_HEADER_SIZE;
+
+	for (int index = 0; index < numParameters; ++index)
+	{
+		const auto* parameter = m_parameters[index];
+		const float value = parameter->convertFrom0to1(parameter->getValue());
+
+		juce::uint32 bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		juce::ByteOrder::writeLittleEndianInt(bytes, m_parameterHashes[index]);
+		juce::ByteOrder::writeLittleEndianInt(bytes + 4, bits);
+		bytes += STATE_ENTRY_SIZE;
+	}
 }
 
 void HarmonicsAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+	if (setBinaryState(data, sizeInBytes))
+	{
+		return;
+	}
+
+	// Older versions saved the value tree as XML
 	std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
 
 	if (xmlState.get() != nullptr)
+	{
 		if (xmlState->hasTagName(apvts.state.getType()))
+		{
+			const juce::ScopedLock lock(m_parameterLock);
+
+			m_parameterSequence.fetch_add(1, std::memory_order_acq_rel);
 			apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+			m_parameterSequence.fetch_add(1, std::memory_order_release);
+		}
+	}
+}
+
+bool HarmonicsAudioProcessor::setBinaryState(const void* data, int sizeInBytes)
+{
+	if (data == nullptr || sizeInBytes < STATE_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	const auto* bytes = static_cast<const char*>(data);
+
+	if (juce::ByteOrder::littleEndianInt(bytes) != STATE_MAGIC)
+	{
+		return false;
+	}
+
+	// Newer versions only append to the format, what is there still reads the same way
+	const int numEntries = juce::jmin((int)juce::ByteOrder::littleEndianShort(bytes + 6), (sizeInBytes - STATE_HEADER_SIZE) / STATE_ENTRY_SIZE);
+	const int program = (int)juce::ByteOrder::littleEndianInt(bytes + 8);
+	bytes += STATE_HEADER_SIZE;
+
+	// Parameters missing from the state get their default
+	const int numParameters = (int)m_parameters.size();
+
+	for (int index = 0; index < numParameters; ++index)
+	{
+		m_stateValues[index] = m_parameters[index]->getDefaultValue();
+	}
+
+	for (int entry = 0; entry < numEntries; ++entry)
+	{
+		const auto hash = juce::ByteOrder::littleEndianInt(bytes);
+		const auto bits = juce::ByteOrder::littleEndianInt(bytes + 4);
+		bytes += STATE_ENTRY_SIZE;
+
+		const auto found = std::find(m_parameterHashes.begin(), m_parameterHashes.end(), hash);
+
+		if (found != m_parameterHashes.end())
+		{
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+
+			const int index = (int)(found - m_parameterHashes.begin());
+			m_stateValues[index] = m_parameters[index]->convertTo0to1(value);
+		}
+	}
+
+	m_currentProgram = juce::jlimit(0, PresetBank::NUM_PRESETS - 1, program);
+	applyParameterValues(m_stateValues.data());
+
+	return true;
+}
+
+void HarmonicsAudioProcessor::applyParameterValues(const float* values)
+{
+	const juce::ScopedLock lock(m_parameterLock);
+
+	// The audio thread keeps its previous values until the sequence is even again
+	m_parameterSequence.fetch_add(1, std::memory_order_acq_rel);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (size_t index = 0; index < m_parameters.size(); ++index)
+	{
+		if (m_parameters[index]->getValue() != values[index])
+		{
+			m_parameters[index]->setValueNotifyingHost(values[index]);
+		}
+	}
+
+	m_parameterSequence.fetch_add(1, std::memory_order_release);
+}
+
+void HarmonicsAudioProcessor::readParameterValues()
+{
+	const unsigned int sequence = m_parameterSequence.load(std::memory_order_acquire);
+
+	if ((sequence & 1) != 0)
+	{
+		return;
+	}
+
+	HarmonicsSettings values;
+	values.gain = gainParameter->load(std::memory_order_relaxed);
+	values.mix = mixParameter->load(std::memory_order_relaxed);
+	values.volume = volumeParameter->load(std::memory_order_relaxed);
+	values.cutoff = cutoffParameter->load(std::memory_order_relaxed);
+	values.Q = qParameter->load(std::memory_order_relaxed);
+
+	values.button2 = button2Parameter->get();
+	values.button4 = button4Parameter->get();
+	values.button6 = button6Parameter->get();
+	values.button8 = button8Parameter->get();
+
+	values.oversampling = oversamplingParameter->getIndex();
+	values.chebyshev = engineParameter->getIndex() == 1;
+
+	for (int harmonic = 2; harmonic <= ChebyshevLevels::maxHarmonic; ++harmonic)
+	{
+		values.levels.level[harmonic] = harmonicParameters[harmonic]->load(std::memory_order_relaxed);
+	}
+
+	values.limiter = limiterParameter->get();
+	values.lookahead = lookaheadTimes[juce::jlimit(0, lookaheadNames.size() - 1, lookaheadParameter->getIndex())];
+
+	values.midSide = modeParameter->getIndex() == 1;
+	values.sideGain = sideGainParameter->load(std::memory_order_relaxed);
+	values.sideMix = sideMixParameter->load(std::memory_order_relaxed);
+	values.sideButton2 = sideButton2Parameter->get();
+	values.sideButton4 = sideButton4Parameter->get();
+	values.sideButton6 = sideButton6Parameter->get();
+	values.sideButton8 = sideButton8Parameter->get();
+
+	values.envelope = envelopeParameter->get();
+	values.sidechain = sidechainParameter->get();
+	values.depth = depthParameter->load(std::memory_order_relaxed);
+	values.attack = attackParameter->load(std::memory_order_relaxed);
+	values.release = releaseParameter->load(std::memory_order_relaxed);
+
+	// A writer started meanwhile, the copy may be mixed
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	if (m_parameterSequence.load(std::memory_order_relaxed) == sequence)
+	{
+		m_values = values;
+	}
+}
+
+void HarmonicsAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+	// May come from the audio thread, setLatencySamples() is left to the message thread
+	triggerAsyncUpdate();
+}
+
+void HarmonicsAudioProcessor::handleAsyncUpdate()
+{
+	updateLatency();
+}
+
+void HarmonicsAudioProcessor::updateLatency()
+{
+	// Only the latency relevant fields, worked out from the parameters as the next block will apply them
+	HarmonicsSettings settings;
+	settings.oversampling = oversamplingParameter->getIndex();
+	settings.limiter = limiterParameter->get();
+	settings.lookahead = lookaheadTimes[juce::jlimit(0, lookaheadNames.size() - 1, lookaheadParameter->getIndex())];
+
+	const int latency = isUsingDoublePrecision() ? m_doubleCore.getLatency(settings) : m_floatCore.getLatency(settings);
+
+	if (latency != getLatencySamples())
+	{
+		setLatencySamples(latency);
+	}
+}
+
+juce::uint32 HarmonicsAudioProcessor::hashParameterID(const juce::String& id)
+{
+	// FNV-1a, 32 bit
+	juce::uint32 hash = 2166136261u;
+
+	for (auto character = id.getCharPointer(); ! character.isEmpty(); ++character)
+	{
+		hash = (hash ^ (juce::uint32)*character) * 16777619u;
+	}
+
+	return hash;
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout HarmonicsAudioProcessor::createParameterLayout()
@@ -304,11 +658,48 @@ juce::AudioProcessorValueTreeState::ParameterLayout HarmonicsAudioProcessor::cre
 	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[1], paramsNames[1], NormalisableRange<float>(  0.0f,  1.0f, 0.05f, 1.0f), 1.0f));
 	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[2], paramsNames[2], NormalisableRange<float>(-24.0f, 24.0f,  0.1f, 1.0f), 0.0f));
 
+	// DC blocker after every harmonic stage
+	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[3], paramsNames[3], NormalisableRange<float>( 10.0f, 1000.0f, 0.1f, 0.3f), 20.0f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[4], paramsNames[4], NormalisableRange<float>(  0.5f,  2.0f, 0.01f, 1.0f), 0.7f));
+
 	layout.add(std::make_unique<juce::AudioParameterBool>("Button2", "Button2", true));
 	layout.add(std::make_unique<juce::AudioParameterBool>("Button4", "Button4", false));
 	layout.add(std::make_unique<juce::AudioParameterBool>("Button6", "Button6", false));
 	layout.add(std::make_unique<juce::AudioParameterBool>("Button8", "Button8", false));
 
+	layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling", oversamplingNames, 0));
+
+	// Mid/side on stereo layouts, Gain/Mix/Button2-8 then act on mid and these on side
+	layout.add(std::make_unique<juce::AudioParameterChoice>("Mode", "Mode", modeNames, 0));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[5], paramsNames[5], NormalisableRange<float>(-24.0f, 24.0f,  0.1f, 1.0f), 0.0f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[6], paramsNames[6], NormalisableRange<float>(  0.0f,  1.0f, 0.05f, 1.0f), 1.0f));
+	layout.add(std::make_unique<juce::AudioParameterBool>("SideButton2", "SideButton2", true));
+	layout.add(std::make_unique<juce::AudioParameterBool>("SideButton4", "SideButton4", false));
+	layout.add(std::make_unique<juce::AudioParameterBool>("SideButton6", "SideButton6", false));
+	layout.add(std::make_unique<juce::AudioParameterBool>("SideButton8", "SideButton8", false));
+
+	// True-peak lookahead limiter on the output, replaces the hard clip at 0 dB
+	layout.add(std::make_unique<juce::AudioParameterBool>("Limiter", "Limiter", false));
+	layout.add(std::make_unique<juce::AudioParameterChoice>("Lookahead", "Lookahead", lookaheadNames, 1));
+
+	// Envelope follower on the input or the sidechain, depth 1 drives every level to the same
+	// harmonic amount, attack and release in ms. Attack is capped at the release time
+	layout.add(std::make_unique<juce::AudioParameterBool>("Envelope", "Envelope", false));
+	layout.add(std::make_unique<juce::AudioParameterBool>("Sidechain", "Sidechain", false));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[7], paramsNames[7], NormalisableRange<float>(  0.0f,    1.0f, 0.01f, 1.0f),   1.0f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[8], paramsNames[8], NormalisableRange<float>(  0.1f,  100.0f,  0.1f, 0.4f),   5.0f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[9], paramsNames[9], NormalisableRange<float>(  5.0f, 2000.0f,  1.0f, 0.3f), 150.0f));
+
+	// Classic is the Button2-8 chain, Chebyshev uses the levels below.
+	// A level is the harmonic amplitude for a full scale sine
+	layout.add(std::make_unique<juce::AudioParameterChoice>("Engine", "Engine", engineNames, 0));
+
+	for (int harmonic = 2; harmonic <= ChebyshevLevels::maxHarmonic; ++harmonic)
+	{
+		const auto id = getHarmonicParameterID(harmonic);
+		layout.add(std::make_unique<juce::AudioParameterFloat>(id, id, NormalisableRange<float>(0.0f, 1.0f, 0.01f, 1.0f), harmonic == 2 ? 1.0f : 0.0f));
+	}
+
 	return layout;
 }
 
@@ -9,36 +9,18 @@
 #pragma once
 
 #include <JuceHeader.h>
-//==============================================================================
-class SecondOrderHighPass
-{
-public:
-	SecondOrderHighPass();
-
-	void init(int sampleRate);
-	void setCoef(float frequency, float Q);
-	float process(float in);
-
-protected:
-	float m_sampleRate;
-	float m_a0 = 0.9964426738810956f;
-	float m_a1 = -1.9928853477621913f;
-	float m_a2 = 0.9964426738810956f;
-	float m_b0 = 1.0f;
-	float m_b1 = -1.9928691659478477f;
-	float m_b2 = 0.992901529576535f;
-
-	float m_x1 = 0.0f;
-	float m_x2 = 0.0f;
-	float m_y1 = 0.0f;
-	float m_y2 = 0.0f;
-};
+#include "HarmonicsCore.h"
+#include "HarmonicsAnalysis.h"
+#include "ProcessProfiler.h"
+#include "WorkerPool.h"
 
 //==============================================================================
 class HarmonicsAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                             , private juce::AudioProcessorValueTreeState::Listener
+                             , private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -46,6 +28,36 @@ public:
     ~HarmonicsAudioProcessor() override;
 
 	static const std::string paramsNames[];
+	static const juce::StringArray oversamplingNames;
+	static const juce::StringArray engineNames;
+	static const juce::StringArray modeNames;
+	static const juce::StringArray lookaheadNames;
+	static const float lookaheadTimes[];
+	static const char* const latencyParameterIDs[3];
+
+	// Chebyshev engine level parameters are "Harmonic2" ... "Harmonic16"
+	static juce::String getHarmonicParameterID(int harmonic) { return "Harmonic" + juce::String(harmonic); };
+
+	// Largest layout the DSP core takes
+	static const int MAX_CHANNELS = HarmonicsCore<float>::MAX_CHANNELS;
+	static constexpr float TAIL_TIME = 0.3f;
+
+	// Channel groups run in parallel on the shared worker pool only with at least
+	// two groups and this many kernel samples each, below that the hand-off costs more.
+	// The audio thread then waits for every group a worker has claimed. On an overloaded
+	// machine the OS may pre-empt that worker and hold up the audio thread (priority
+	// inversion), which is why parallel processing is off by default
+	static const int PARALLEL_MIN_SAMPLES = 2048;
+
+	// Sidechain input, the envelope follows it instead of the input when enabled
+	static const int SIDECHAIN_BUS = 1;
+
+	// Binary state, little endian: magic, version, parameter count, program,
+	// then per parameter the FNV-1a hash of its ID and its plain value
+	static const juce::uint32 STATE_MAGIC = 0x534d5248;	// "HRMS"
+	static const int STATE_VERSION = 1;
+	static const int STATE_HEADER_SIZE = 12;
+	static const int STATE_ENTRY_SIZE = 8;
 
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
@@ -56,6 +68,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -85,12 +99,64 @@ public:
 
 	APVTS apvts{ *this, nullptr, "Parameters", createParameterLayout() };
 
+	// Meters and output samples for the editor, only filled while it is enabled
+	HarmonicsAnalysis& getAnalysis() { return m_analysis; };
+
+	// processBlock timing, compiled out with HARMONICS_PROFILING=0
+	const ProcessProfiler& getProfiler() const { return m_profiler; };
+
+	// Off by default, the output is bit-identical either way. Message thread only, turning it
+	// on takes effect with the next prepareToPlay, turning it off right away
+	void setParallelProcessing(bool enabled);
+
+	// Levels summed over all blocks since the last take, for offline tools. Not thread safe,
+	// only call between processBlock calls
+	void setOfflineMetering(bool enabled) { m_offlineMetering = enabled; };
+	HarmonicsMeter takeOfflineMeter() { const HarmonicsMeter meter = m_offlineMeter; m_offlineMeter = {}; return meter; };
+
+	static juce::uint32 hashParameterID(const juce::String& id);
+
 private:	
+	//==============================================================================
+	// DSP at one processing precision, only the one in use is prepared
+	HarmonicsCore<float>& getCore(const juce::AudioBuffer<float>&) { return m_floatCore; };
+	HarmonicsCore<double>& getCore(const juce::AudioBuffer<double>&) { return m_doubleCore; };
+
+	template <typename SampleType>
+	void process(juce::AudioBuffer<SampleType>& buffer);
+
+	template <typename SampleType>
+	bool isInputSilent(const juce::AudioBuffer<SampleType>& buffer, int channels, int samples) const;
+
+	// Keeps the previous values while a preset or state is half applied
+	void readParameterValues();
+
+	// Oversampling, Limiter and Lookahead change the latency, the host hears about it
+	// from the message thread and never from processBlock
+	void parameterChanged(const juce::String& parameterID, float newValue) override;
+	void handleAsyncUpdate() override;
+	void updateLatency();
+
+	// Holds a user of the shared worker pool while this instance may run groups on it
+	void updateWorkerPool(bool inUse);
+
+	// Normalised values in m_parameters order, only the changed ones are set
+	void applyParameterValues(const float* values);
+
+	bool setBinaryState(const void* data, int sizeInBytes);
+
 	//==============================================================================
 	//std::atomic<float>* tiltParameter = nullptr;
 	std::atomic<float>* gainParameter = nullptr;
 	std::atomic<float>* mixParameter = nullptr;
 	std::atomic<float>* volumeParameter = nullptr;
+	std::atomic<float>* cutoffParameter = nullptr;
+	std::atomic<float>* qParameter = nullptr;
+	std::atomic<float>* sideGainParameter = nullptr;
+	std::atomic<float>* sideMixParameter = nullptr;
+	std::atomic<float>* depthParameter = nullptr;
+	std::atomic<float>* attackParameter = nullptr;
+	std::atomic<float>* releaseParameter = nullptr;
 
 	juce::AudioParameterBool* button2Parameter = nullptr;
 	//juce::AudioParameterBool* button3Parameter = nullptr;
@@ -101,10 +167,46 @@ private:
 	juce::AudioParameterBool* button8Parameter = nullptr;
 	//juce::AudioParameterBool* button9Parameter = nullptr;
 
-	SecondOrderHighPass m_secondOrderHighPass2[2] = {};
-	SecondOrderHighPass m_secondOrderHighPass4[2] = {};
-	SecondOrderHighPass m_secondOrderHighPass6[2] = {};
-	SecondOrderHighPass m_secondOrderHighPass8[2] = {};
+	juce::AudioParameterChoice* modeParameter = nullptr;
+	juce::AudioParameterBool* sideButton2Parameter = nullptr;
+	juce::AudioParameterBool* sideButton4Parameter = nullptr;
+	juce::AudioParameterBool* sideButton6Parameter = nullptr;
+	juce::AudioParameterBool* sideButton8Parameter = nullptr;
+
+	juce::AudioParameterChoice* oversamplingParameter = nullptr;
+	juce::AudioParameterChoice* engineParameter = nullptr;
+	juce::AudioParameterBool* limiterParameter = nullptr;
+	juce::AudioParameterChoice* lookaheadParameter = nullptr;
+	juce::AudioParameterBool* envelopeParameter = nullptr;
+	juce::AudioParameterBool* sidechainParameter = nullptr;
+	std::atomic<float>* harmonicParameters[ChebyshevLevels::maxHarmonic + 1] = {};
+
+	// All parameters with their ID hashes, for the binary state and the presets
+	std::vector<juce::RangedAudioParameter*> m_parameters;
+	std::vector<juce::uint32> m_parameterHashes;
+
+	// Factory presets resolved to normalised values, one row per preset
+	std::vector<float> m_presetValues;
+	std::vector<float> m_stateValues;
+	int m_currentProgram = 0;
+
+	// Odd while applyParameterValues() is changing parameters
+	std::atomic<unsigned int> m_parameterSequence { 0 };
+	juce::CriticalSection m_parameterLock;
+	HarmonicsSettings m_values;
+
+	HarmonicsCore<float> m_floatCore;
+	HarmonicsCore<double> m_doubleCore;
+
+	HarmonicsAnalysis m_analysis;
+	ProcessProfiler m_profiler;
+
+	bool m_offlineMetering = false;
+	HarmonicsMeter m_offlineMeter;
+
+	juce::SharedResourcePointer<WorkerPool> m_workerPool;
+	bool m_parallelProcessing = false;
+	std::atomic<bool> m_usingWorkerPool { false };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HarmonicsAudioProcessor)
 };
@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    Factory presets, exposed to the host as programs.
+
+    A preset lists only the parameters it changes, by ID and plain value.
+    Everything it leaves out is set to its default, so a preset always
+    sounds the same whatever was loaded before it. The processor resolves
+    the table to normalised values once, switching presets then only copies
+    floats into parameters.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//==============================================================================
+namespace PresetBank
+{
+	static const int MAX_VALUES = 24;
+
+	struct Value
+	{
+		const char* id;
+		float value;
+	};
+
+	// Values end at the first entry without an ID
+	struct Preset
+	{
+		const char* name;
+		Value values[MAX_VALUES];
+	};
+
+	static const Preset presets[] =
+	{
+		{ "Default", {} },
+		{ "Subtle Warmth", { { "Gain", -6.0f }, { "Mix", 0.35f }, { "Volume", 2.0f } } },
+		{ "Rich Even", { { "Gain", 6.0f }, { "Mix", 0.6f }, { "Volume", -4.0f }, { "Button4", 1.0f }, { "Button6", 1.0f } } },
+		{ "Full Stack", { { "Gain", 9.0f }, { "Mix", 0.5f }, { "Volume", -8.0f }, { "Button4", 1.0f }, { "Button6", 1.0f }, { "Button8", 1.0f }, { "Oversampling", 2.0f } } },
+		{ "Chebyshev Odd", { { "Engine", 1.0f }, { "Mix", 0.5f }, { "Harmonic2", 0.0f }, { "Harmonic3", 0.5f }, { "Harmonic5", 0.25f }, { "Harmonic7", 0.12f }, { "Oversampling", 1.0f } } },
+		{ "Chebyshev Tube", { { "Engine", 1.0f }, { "Mix", 0.4f }, { "Harmonic2", 0.6f }, { "Harmonic3", 0.2f }, { "Harmonic4", 0.15f }, { "Harmonic6", 0.05f }, { "Oversampling", 1.0f } } },
+		{ "Side Sheen", { { "Mode", 1.0f }, { "Mix", 0.2f }, { "SideGain", 6.0f }, { "SideMix", 0.6f }, { "SideButton4", 1.0f }, { "SideButton6", 1.0f } } },
+		{ "Limited Drive", { { "Gain", 12.0f }, { "Volume", -3.0f }, { "Button4", 1.0f }, { "Oversampling", 1.0f }, { "Limiter", 1.0f }, { "Lookahead", 2.0f } } },
+		{ "Even Follower", { { "Mix", 0.5f }, { "Button4", 1.0f }, { "Envelope", 1.0f }, { "Depth", 0.7f }, { "Attack", 10.0f }, { "Release", 250.0f } } }
+	};
+
+	static const int NUM_PRESETS = (int)(sizeof(presets) / sizeof(presets[0]));
+}
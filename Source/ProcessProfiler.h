@@ -0,0 +1,239 @@
+/*
+  ==============================================================================
+
+    ProcessProfiler.h
+    Time spent in processBlock, measured with the CPU cycle counter.
+
+    The audio thread packs the cycles and the sample count of every block
+    into one 64-bit word of a ring of the newest RING_SIZE blocks, a relaxed
+    store, and counts the blocks that took longer than they last. Readers
+    copy the ring without locking, an entry overwritten meanwhile is just a
+    newer block, and work out min/average/p99/max and a load histogram from
+    the copy. Cycles are converted to seconds against the high resolution
+    timer, calibrated briefly in prepare() and refined on every read.
+
+    HARMONICS_PROFILING=0 compiles all of it out, the scope is then empty
+    and getStats() returns false.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <numeric>
+
+#ifndef HARMONICS_PROFILING
+ #define HARMONICS_PROFILING 1
+#endif
+
+#if HARMONICS_PROFILING
+ #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <intrin.h>
+ #elif defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+ #endif
+#endif
+
+//==============================================================================
+class ProcessProfiler
+{
+public:
+	static const int RING_SIZE = 4096;
+
+	// Load in 10% steps of the block duration, the last bin holds the overloads
+	static const int HISTOGRAM_BINS = 11;
+
+	struct Stats
+	{
+		int blocks = 0;					// In the ring
+		juce::uint64 totalBlocks = 0;
+		juce::uint32 overloads = 0;		// Since prepare()
+
+		double minMicroseconds = 0.0;
+		double averageMicroseconds = 0.0;
+		double p99Microseconds = 0.0;
+		double maxMicroseconds = 0.0;
+
+		// Time over block duration
+		double averageLoad = 0.0;
+		double p99Load = 0.0;
+		double maxLoad = 0.0;
+
+		int histogram[HISTOGRAM_BINS] = {};
+	};
+
+#if HARMONICS_PROFILING
+	static juce::uint64 getCycles()
+	{
+	   #if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || defined(__i386__)
+		return (juce::uint64)__rdtsc();
+	   #elif defined(__aarch64__)
+		juce::uint64 cycles;
+		asm volatile("mrs %0, cntvct_el0" : "=r"(cycles));
+		return cycles;
+	   #else
+		return (juce::uint64)juce::Time::getHighResolutionTicks();
+	   #endif
+	}
+
+	class Scope
+	{
+	public:
+		Scope(ProcessProfiler& profiler, int samples) : m_profiler(profiler), m_samples(samples), m_start(getCycles()) {};
+		~Scope() { m_profiler.add(getCycles() - m_start, m_samples); };
+
+	private:
+		ProcessProfiler& m_profiler;
+		const int m_samples;
+		const juce::uint64 m_start;
+	};
+
+	ProcessProfiler();
+
+	// Message thread, not while processing. Clears the ring and the overload count
+	void prepare(double sampleRate);
+
+	// Any thread, false until a block was measured
+	bool getStats(Stats& stats) const;
+
+protected:
+	// Sample count in the upper bits, cycles in the lower ones
+	static const int CYCLE_BITS = 44;
+	static constexpr juce::uint64 CYCLE_MASK = ((juce::uint64)1 << CYCLE_BITS) - 1;
+	static const int MAX_SAMPLES = (1 << (64 - CYCLE_BITS)) - 1;
+
+	void add(juce::uint64 cycles, int samples);
+	double getCyclesPerSecond() const;
+
+	std::unique_ptr<std::atomic<juce::uint64>[]> m_ring;
+	std::atomic<juce::uint64> m_blocks { 0 };
+	std::atomic<juce::uint32> m_overloads { 0 };
+
+	// Budget of one sample, for the overload count on the audio thread. Refined by readers
+	mutable std::atomic<double> m_cyclesPerSample { 0.0 };
+
+	double m_sampleRate = 48000.0;
+	juce::uint64 m_anchorCycles = 0;
+	juce::int64 m_anchorTicks = 0;
+	double m_calibratedCyclesPerSecond = 1.0;
+#else
+	class Scope
+	{
+	public:
+		Scope(ProcessProfiler&, int) {};
+	};
+
+	void prepare(double) {};
+	bool getStats(Stats&) const { return false; };
+#endif
+};
+
+#if HARMONICS_PROFILING
+inline ProcessProfiler::ProcessProfiler()
+	: m_ring(new std::atomic<juce::uint64>[RING_SIZE])
+{
+	for (int index = 0; index < RING_SIZE; ++index)
+	{
+		m_ring[index].store(0, std::memory_order_relaxed);
+	}
+}
+
+inline void ProcessProfiler::prepare(double sampleRate)
+{
+	m_sampleRate = sampleRate;
+	m_blocks.store(0);
+	m_overloads.store(0);
+
+	// First estimate over 2 ms, getStats() keeps refining it from the same anchor
+	const double ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+	const auto calibrationTicks = (juce::int64)(0.002 * ticksPerSecond);
+
+	m_anchorTicks = juce::Time::getHighResolutionTicks();
+	m_anchorCycles = getCycles();
+
+	while (juce::Time::getHighResolutionTicks() - m_anchorTicks < calibrationTicks)
+	{
+	}
+
+	m_calibratedCyclesPerSecond = getCyclesPerSecond();
+	m_cyclesPerSample.store(m_calibratedCyclesPerSecond / m_sampleRate);
+}
+
+inline double ProcessProfiler::getCyclesPerSecond() const
+{
+	const auto ticks = juce::Time::getHighResolutionTicks() - m_anchorTicks;
+	const auto cycles = getCycles() - m_anchorCycles;
+
+	return ticks > 0 ? (double)cycles * (double)juce::Time::getHighResolutionTicksPerSecond() / (double)ticks : m_calibratedCyclesPerSecond;
+}
+
+inline void ProcessProfiler::add(juce::uint64 cycles, int samples)
+{
+	const auto block = m_blocks.load(std::memory_order_relaxed);
+	const auto packed = ((juce::uint64)juce::jlimit(0, MAX_SAMPLES, samples) << CYCLE_BITS) | juce::jmin(cycles, CYCLE_MASK);
+
+	m_ring[(int)(block % RING_SIZE)].store(packed, std::memory_order_relaxed);
+	m_blocks.store(block + 1, std::memory_order_release);
+
+	// Single writer, no read-modify-write needed
+	if ((double)cycles > (double)samples * m_cyclesPerSample.load(std::memory_order_relaxed))
+	{
+		m_overloads.store(m_overloads.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+}
+
+inline bool ProcessProfiler::getStats(Stats& stats) const
+{
+	stats = Stats();
+	stats.totalBlocks = m_blocks.load(std::memory_order_acquire);
+	stats.overloads = m_overloads.load(std::memory_order_relaxed);
+	stats.blocks = (int)juce::jmin((juce::uint64)RING_SIZE, stats.totalBlocks);
+
+	if (stats.blocks == 0)
+	{
+		return false;
+	}
+
+	// The longer since prepare() the better the estimate, the audio thread gets it too
+	const double cyclesPerSecond = getCyclesPerSecond();
+	m_cyclesPerSample.store(cyclesPerSecond / m_sampleRate, std::memory_order_relaxed);
+
+	const double microsecondsPerCycle = 1e6 / cyclesPerSecond;
+
+	std::vector<double> times((size_t)stats.blocks);
+	std::vector<double> loads((size_t)stats.blocks);
+
+	for (int index = 0; index < stats.blocks; ++index)
+	{
+		const auto packed = m_ring[index].load(std::memory_order_relaxed);
+		const int samples = (int)(packed >> CYCLE_BITS);
+
+		times[index] = (double)(packed & CYCLE_MASK) * microsecondsPerCycle;
+		loads[index] = samples > 0 ? times[index] * 1e-6 * m_sampleRate / samples : 0.0;
+
+		stats.histogram[juce::jmin(HISTOGRAM_BINS - 1, (int)(loads[index] * (HISTOGRAM_BINS - 1)))]++;
+	}
+
+	auto percentile = [](std::vector<double>& values, double fraction)
+	{
+		const auto position = values.begin() + (std::ptrdiff_t)(fraction * (double)(values.size() - 1));
+		std::nth_element(values.begin(), position, values.end());
+		return *position;
+	};
+
+	const auto range = std::minmax_element(times.begin(), times.end());
+	stats.minMicroseconds = *range.first;
+	stats.maxMicroseconds = *range.second;
+	stats.averageMicroseconds = std::accumulate(times.begin(), times.end(), 0.0) / stats.blocks;
+	stats.p99Microseconds = percentile(times, 0.99);
+
+	stats.maxLoad = *std::max_element(loads.begin(), loads.end());
+	stats.averageLoad = std::accumulate(loads.begin(), loads.end(), 0.0) / stats.blocks;
+	stats.p99Load = percentile(loads, 0.99);
+
+	return true;
+}
+#endif
@@ -0,0 +1,582 @@
+/*
+  ==============================================================================
+
+    SIMDVector.h
+    Minimal 4 lane float and 2 lane double vectors used by the channel-parallel
+    kernels, plus single lane wrappers with the same interface for the scalar
+    path. Every lane carries one channel, so the arithmetic done per lane is
+    the same as in the scalar code. isAbove(a, b) is 1 in the lanes where
+    a > b and 0 in the others.
+
+    Define HARMONICS_FORCE_SCALAR to build without SSE/NEON.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if ! defined (HARMONICS_FORCE_SCALAR) && (defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2))
+ #define HARMONICS_SIMD_SSE 1
+ #include <emmintrin.h>
+#elif ! defined (HARMONICS_FORCE_SCALAR) && (defined (__ARM_NEON) || defined (__ARM_NEON__) || defined (_M_ARM64))
+ #define HARMONICS_SIMD_NEON 1
+ #include <arm_neon.h>
+#endif
+
+#if HARMONICS_SIMD_SSE || HARMONICS_SIMD_NEON
+ #define HARMONICS_SIMD 1
+#else
+ #define HARMONICS_SIMD 0
+#endif
+
+// Double lanes need SSE2 or AArch64, 32 bit NEON has no double vectors
+#if HARMONICS_SIMD_NEON && (defined (__aarch64__) || defined (_M_ARM64))
+ #define HARMONICS_SIMD_NEON64 1
+#endif
+
+#if HARMONICS_SIMD_SSE || HARMONICS_SIMD_NEON64
+ #define HARMONICS_SIMD_DOUBLE 1
+#else
+ #define HARMONICS_SIMD_DOUBLE 0
+#endif
+
+//==============================================================================
+struct FloatVec4
+{
+	using Sample = float;
+	static const int size = 4;
+
+#if HARMONICS_SIMD_SSE
+	__m128 v;
+
+	static FloatVec4 broadcast(float value)                       { return { _mm_set1_ps(value) }; }
+	static FloatVec4 set(float a, float b, float c, float d)      { return { _mm_setr_ps(a, b, c, d) }; }
+	static FloatVec4 load(const float* src)                       { return { _mm_loadu_ps(src) }; }
+	void store(float* dest) const                                 { _mm_storeu_ps(dest, v); }
+
+	friend FloatVec4 operator+ (FloatVec4 a, FloatVec4 b)         { return { _mm_add_ps(a.v, b.v) }; }
+	friend FloatVec4 operator- (FloatVec4 a, FloatVec4 b)         { return { _mm_sub_ps(a.v, b.v) }; }
+	friend FloatVec4 operator* (FloatVec4 a, FloatVec4 b)         { return { _mm_mul_ps(a.v, b.v) }; }
+	friend FloatVec4 operator/ (FloatVec4 a, FloatVec4 b)         { return { _mm_div_ps(a.v, b.v) }; }
+	static FloatVec4 min(FloatVec4 a, FloatVec4 b)                { return { _mm_min_ps(a.v, b.v) }; }
+	static FloatVec4 max(FloatVec4 a, FloatVec4 b)                { return { _mm_max_ps(a.v, b.v) }; }
+	static FloatVec4 abs(FloatVec4 a)                             { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+	static FloatVec4 isAbove(FloatVec4 a, FloatVec4 b)            { return { _mm_and_ps(_mm_cmpgt_ps(a.v, b.v), _mm_set1_ps(1.0f)) }; }
+#elif HARMONICS_SIMD_NEON
+	float32x4_t v;
+
+	static FloatVec4 broadcast(float value)                       { return { vdupq_n_f32(value) }; }
+	static FloatVec4 set(float a, float b, float c, float d)      { const float lanes[4] = { a, b, c, d }; return { vld1q_f32(lanes) }; }
+	static FloatVec4 load(const float* src)                       { return { vld1q_f32(src) }; }
+	void store(float* dest) const                                 { vst1q_f32(dest, v); }
+
+	friend FloatVec4 operator+ (FloatVec4 a, FloatVec4 b)         { return { vaddq_f32(a.v, b.v) }; }
+	friend FloatVec4 operator- (FloatVec4 a, FloatVec4 b)         { return { vsubq_f32(a.v, b.v) }; }
+	friend FloatVec4 operator* (FloatVec4 a, FloatVec4 b)         { return { vmulq_f32(a.v, b.v) }; }
+  #if HARMONICS_SIMD_NEON64
+	friend FloatVec4 operator/ (FloatVec4 a, FloatVec4 b)         { return { vdivq_f32(a.v, b.v) }; }
+  #else
+	// No divide on 32 bit NEON, reciprocal estimate refined twice (about 1 ulp)
+	friend FloatVec4 operator/ (FloatVec4 a, FloatVec4 b)
+	{
+		float32x4_t reciprocal = vrecpeq_f32(b.v);
+		reciprocal = vmulq_f32(vrecpsq_f32(b.v, reciprocal), reciprocal);
+		reciprocal = vmulq_f32(vrecpsq_f32(b.v, reciprocal), reciprocal);
+		return { vmulq_f32(a.v, reciprocal) };
+	}
+  #endif
+	static FloatVec4 min(FloatVec4 a, FloatVec4 b)                { return { vminq_f32(a.v, b.v) }; }
+	static FloatVec4 max(FloatVec4 a, FloatVec4 b)                { return { vmaxq_f32(a.v, b.v) }; }
+	static FloatVec4 abs(FloatVec4 a)                             { return { vabsq_f32(a.v) }; }
+	static FloatVec4 isAbove(FloatVec4 a, FloatVec4 b)            { return { vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(a.v, b.v), vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))) }; }
+#else
+	float v[4];
+
+	static FloatVec4 broadcast(float value)                       { return { { value, value, value, value } }; }
+	static FloatVec4 set(float a, float b, float c, float d)      { return { { a, b, c, d } }; }
+	static FloatVec4 load(const float* src)                       { return { { src[0], src[1], src[2], src[3] } }; }
+	void store(float* dest) const                                 { for (int i = 0; i < 4; ++i) dest[i] = v[i]; }
+
+	friend FloatVec4 operator+ (FloatVec4 a, FloatVec4 b)         { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+	friend FloatVec4 operator- (FloatVec4 a, FloatVec4 b)         { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+	friend FloatVec4 operator* (FloatVec4 a, FloatVec4 b)         { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+	friend FloatVec4 operator/ (FloatVec4 a, FloatVec4 b)         { return { { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] } }; }
+	static FloatVec4 min(FloatVec4 a, FloatVec4 b)                { return { { fminf(a.v[0], b.v[0]), fminf(a.v[1], b.v[1]), fminf(a.v[2], b.v[2]), fminf(a.v[3], b.v[3]) } }; }
+	static FloatVec4 max(FloatVec4 a, FloatVec4 b)                { return { { fmaxf(a.v[0], b.v[0]), fmaxf(a.v[1], b.v[1]), fmaxf(a.v[2], b.v[2]), fmaxf(a.v[3], b.v[3]) } }; }
+	static FloatVec4 abs(FloatVec4 a)                             { return { { fabsf(a.v[0]), fabsf(a.v[1]), fabsf(a.v[2]), fabsf(a.v[3]) } }; }
+	static FloatVec4 isAbove(FloatVec4 a, FloatVec4 b)            { return { { a.v[0] > b.v[0] ? 1.0f : 0.0f, a.v[1] > b.v[1] ? 1.0f : 0.0f, a.v[2] > b.v[2] ? 1.0f : 0.0f, a.v[3] > b.v[3] ? 1.0f : 0.0f } }; }
+#endif
+};
+
+//==============================================================================
+struct FloatVec1
+{
+	using Sample = float;
+	static const int size = 1;
+
+	float v;
+
+	static FloatVec1 broadcast(float value)                       { return { value }; }
+	static FloatVec1 load(const float* src)                       { return { src[0] }; }
+	void store(float* dest) const                                 { dest[0] = v; }
+
+	friend FloatVec1 operator+ (FloatVec1 a, FloatVec1 b)         { return { a.v + b.v }; }
+	friend FloatVec1 operator- (FloatVec1 a, FloatVec1 b)         { return { a.v - b.v }; }
+	friend FloatVec1 operator* (FloatVec1 a, FloatVec1 b)         { return { a.v * b.v }; }
+	friend FloatVec1 operator/ (FloatVec1 a, FloatVec1 b)         { return { a.v / b.v }; }
+
+	// Compare and select like minss/maxss, fminf/fmaxf can end up as libm calls
+	static FloatVec1 min(FloatVec1 a, FloatVec1 b)                { return { a.v < b.v ? a.v : b.v }; }
+	static FloatVec1 max(FloatVec1 a, FloatVec1 b)                { return { a.v > b.v ? a.v : b.v }; }
+	static FloatVec1 abs(FloatVec1 a)                             { return { fabsf(a.v) }; }
+	static FloatVec1 isAbove(FloatVec1 a, FloatVec1 b)            { return { a.v > b.v ? 1.0f : 0.0f }; }
+};
+
+//==============================================================================
+struct DoubleVec2
+{
+	using Sample = double;
+	static const int size = 2;
+
+#if HARMONICS_SIMD_SSE
+	__m128d v;
+
+	static DoubleVec2 broadcast(double value)                     { return { _mm_set1_pd(value) }; }
+	static DoubleVec2 set(double a, double b)                     { return { _mm_setr_pd(a, b) }; }
+	static DoubleVec2 load(const double* src)                     { return { _mm_loadu_pd(src) }; }
+	void store(double* dest) const                                { _mm_storeu_pd(dest, v); }
+
+	friend DoubleVec2 operator+ (DoubleVec2 a, DoubleVec2 b)      { return { _mm_add_pd(a.v, b.v) }; }
+	friend DoubleVec2 operator- (DoubleVec2 a, DoubleVec2 b)      { return { _mm_sub_pd(a.v, b.v) }; }
+	friend DoubleVec2 operator* (DoubleVec2 a, DoubleVec2 b)      { return { _mm_mul_pd(a.v, b.v) }; }
+	friend DoubleVec2 operator/ (DoubleVec2 a, DoubleVec2 b)      { return { _mm_div_pd(a.v, b.v) }; }
+	static DoubleVec2 min(DoubleVec2 a, DoubleVec2 b)             { return { _mm_min_pd(a.v, b.v) }; }
+	static DoubleVec2 max(DoubleVec2 a, DoubleVec2 b)             { return { _mm_max_pd(a.v, b.v) }; }
+	static DoubleVec2 abs(DoubleVec2 a)                           { return { _mm_andnot_pd(_mm_set1_pd(-0.0), a.v) }; }
+	static DoubleVec2 isAbove(DoubleVec2 a, DoubleVec2 b)         { return { _mm_and_pd(_mm_cmpgt_pd(a.v, b.v), _mm_set1_pd(1.0)) }; }
+#elif HARMONICS_SIMD_NEON64
+	float64x2_t v;
+
+	static DoubleVec2 broadcast(double value)                     { return { vdupq_n_f64(value) }; }
+	static DoubleVec2 set(double a, double b)                     { const double lanes[2] = { a, b }; return { vld1q_f64(lanes) }; }
+	static DoubleVec2 load(const double* src)                     { return { vld1q_f64(src) }; }
+	void store(double* dest) const                                { vst1q_f64(dest, v); }
+
+	friend DoubleVec2 operator+ (DoubleVec2 a, DoubleVec2 b)      { return { vaddq_f64(a.v, b.v) }; }
+	friend DoubleVec2 operator- (DoubleVec2 a, DoubleVec2 b)      { return { vsubq_f64(a.v, b.v) }; }
+	friend DoubleVec2 operator* (DoubleVec2 a, DoubleVec2 b)      { return { vmulq_f64(a.v, b.v) }; }
+	friend DoubleVec2 operator/ (DoubleVec2 a, DoubleVec2 b)      { return { vdivq_f64(a.v, b.v) }; }
+	static DoubleVec2 min(DoubleVec2 a, DoubleVec2 b)             { return { vminq_f64(a.v, b.v) }; }
+	static DoubleVec2 max(DoubleVec2 a, DoubleVec2 b)             { return { vmaxq_f64(a.v, b.v) }; }
+	static DoubleVec2 abs(DoubleVec2 a)                           { return { vabsq_f64(a.v) }; }
+	static DoubleVec2 isAbove(DoubleVec2 a, DoubleVec2 b)         { return { vreinterpretq_f64_u64(vandq_u64(vcgtq_f64(a.v, b.v), vreinterpretq_u64_f64(vdupq_n_f64(1.0)))) }; }
+#else
+	double v[2];
+
+	static DoubleVec2 broadcast(double value)                     { return { { value, value } }; }
+	static DoubleVec2 set(double a, double b)                     { return { { a, b } }; }
+	static DoubleVec2 load(const double* src)                     { return { { src[0], src[1] } }; }
+	void store(double* dest) const                                { dest[0] = v[0]; dest[1] = v[1]; }
+
+	friend DoubleVec2 operator+ (DoubleVec2 a, DoubleVec2 b)      { return { { a.v[0] + b.v[0], a.v[1] + b.v[1] } }; }
+	friend DoubleVec2 operator- (DoubleVec2 a, DoubleVec2 b)      { return { { a.v[0] - b.v[0], a.v[1] - b.v[1] } }; }
+	friend DoubleVec2 operator* (DoubleVec2 a, DoubleVec2 b)      { return { { a.v[0] * b.v[0], a.v[1] * b.v[1] } }; }
+	friend DoubleVec2 operator/ (DoubleVec2 a, DoubleVec2 b)      { return { { a.v[0] / b.v[0], a.v[1] / b.v[1] } }; }
+	static DoubleVec2 min(DoubleVec2 a, DoubleVec2 b)             { return { { fmin(a.v[0], b.v[0]), fmin(a.v[1], b.v[1]) } }; }
+	static DoubleVec2 max(DoubleVec2 a, DoubleVec2 b)             { return { { fmax(a.v[0], b.v[0]), fmax(a.v[1], b.v[1]) } }; }
+	static DoubleVec2 abs(DoubleVec2 a)                           { return { { fabs(a.v[0]), fabs(a.v[1]) } }; }
+	static DoubleVec2 isAbove(DoubleVec2 a, DoubleVec2 b)         { return { { a.v[0] > b.v[0] ? 1.0 : 0.0, a.v[1] > b.v[1] ? 1.0 : 0.0 } }; }
+#endif
+};
+
+//==============================================================================
+struct DoubleVec1
+{
+	using Sample = double;
+	static const int size = 1;
+
+	double v;
+
+	static DoubleVec1 broadcast(double value)                     { return { value }; }
+	static DoubleVec1 load(const double* src)                     { return { src[0] }; }
+	void store(double* dest) const                                { dest[0] = v; }
+
+	friend DoubleVec1 operator+ (DoubleVec1 a, DoubleVec1 b)      { return { a.v + b.v }; }
+	friend DoubleVec1 operator- (DoubleVec1 a, DoubleVec1 b)      { return { a.v - b.v }; }
+	friend DoubleVec1 operator* (DoubleVec1 a, DoubleVec1 b)      { return { a.v * b.v }; }
+	friend DoubleVec1 operator/ (DoubleVec1 a, DoubleVec1 b)      { return { a.v / b.v }; }
+
+	static DoubleVec1 min(DoubleVec1 a, DoubleVec1 b)             { return { a.v < b.v ? a.v : b.v }; }
+	static DoubleVec1 max(DoubleVec1 a, DoubleVec1 b)             { return { a.v > b.v ? a.v : b.v }; }
+	static DoubleVec1 abs(DoubleVec1 a)                           { return { fabs(a.v) }; }
+	static DoubleVec1 isAbove(DoubleVec1 a, DoubleVec1 b)         { return { a.v > b.v ? 1.0 : 0.0 }; }
+};
+
+//==============================================================================
+// Widest vector for a sample type on this target
+template <typename SampleType>
+struct SIMDVectorFor;
+
+template <>
+struct SIMDVectorFor<float>
+{
+#if HARMONICS_SIMD
+	using Type = FloatVec4;
+#else
+	using Type = FloatVec1;
+#endif
+};
+
+template <>
+struct SIMDVectorFor<double>
+{
+#if HARMONICS_SIMD_DOUBLE
+	using Type = DoubleVec2;
+#else
+	using Type = DoubleVec1;
+#endif
+};
+
+//==============================================================================
+// One sample of up to Vec::size channels in and out of the lanes. Unused lanes
+// read as zero. The switch is on the block constant channel count, so it is
+// always predicted.
+template <typename Vec>
+inline Vec loadChannels(const typename Vec::Sample* const* channels, int numChannels, int sample);
+
+template <typename Vec>
+inline void storeChannels(Vec value, typename Vec::Sample* const* channels, int numChannels, int sample);
+
+template <>
+inline FloatVec1 loadChannels<FloatVec1>(const float* const* channels, int, int sample)
+{
+	return { channels[0][sample] };
+}
+
+template <>
+inline void storeChannels<FloatVec1>(FloatVec1 value, float* const* channels, int, int sample)
+{
+	channels[0][sample] = value.v;
+}
+
+template <>
+inline FloatVec4 loadChannels<FloatVec4>(const float* const* channels, int numChannels, int sample)
+{
+	switch (numChannels)
+	{
+	case 1:  return FloatVec4::set(channels[0][sample], 0.0f, 0.0f, 0.0f);
+	case 2:  return FloatVec4::set(channels[0][sample], channels[1][sample], 0.0f, 0.0f);
+	case 3:  return FloatVec4::set(channels[0][sample], channels[1][sample], channels[2][sample], 0.0f);
+	default: return FloatVec4::set(channels[0][sample], channels[1][sample], channels[2][sample], channels[3][sample]);
+	}
+}
+
+template <>
+inline void storeChannels<FloatVec4>(FloatVec4 value, float* const* channels, int numChannels, int sample)
+{
+	alignas(16) float lanes[FloatVec4::size];
+	value.store(lanes);
+
+	switch (numChannels)
+	{
+	case 4:  channels[3][sample] = lanes[3]; // fall through
+	case 3:  channels[2][sample] = lanes[2]; // fall through
+	case 2:  channels[1][sample] = lanes[1]; // fall through
+	default: channels[0][sample] = lanes[0];
+	}
+}
+
+template <>
+inline DoubleVec1 loadChannels<DoubleVec1>(const double* const* channels, int, int sample)
+{
+	return { channels[0][sample] };
+}
+
+template <>
+inline void storeChannels<DoubleVec1>(DoubleVec1 value, double* const* channels, int, int sample)
+{
+	channels[0][sample] = value.v;
+}
+
+template <>
+inline DoubleVec2 loadChannels<DoubleVec2>(const double* const* channels, int numChannels, int sample)
+{
+	return numChannels == 1 ? DoubleVec2::set(channels[0][sample], 0.0) : DoubleVec2::set(channels[0][sample], channels[1][sample]);
+}
+
+template <>
+inline void storeChannels<DoubleVec2>(DoubleVec2 value, double* const* channels, int numChannels, int sample)
+{
+	alignas(16) double lanes[DoubleVec2::size];
+	value.store(lanes);
+
+	if (numChannels == 2)
+	{
+		channels[1][sample] = lanes[1];
+	}
+
+	channels[0][sample] = lanes[0];
+}
+
+//==============================================================================
+// Even lanes get one value and odd lanes the other, per lane parameters of a
+// mid/side pair
+template <typename Vec>
+inline Vec lanePair(typename Vec::Sample even, typename Vec::Sample odd)
+{
+	alignas(16) typename Vec::Sample lanes[Vec::size];
+
+	for (int lane = 0; lane < Vec::size; ++lane)
+	{
+		lanes[lane] = lane % 2 == 0 ? even : odd;
+	}
+
+	return Vec::load(lanes);
+}
+
+//==============================================================================
+// Stereo pair encoded on load, mid (L + R) / 2 in lane 0 and side (L - R) / 2
+// in lane 1, decoded to L = M + S and R = M - S on store. A single lane has no
+// room for the pair, FloatVec1 and DoubleVec1 get the deleted primary template.
+template <typename Vec>
+inline Vec loadMidSide(const typename Vec::Sample* const* channels, int sample) = delete;
+
+template <typename Vec>
+inline void storeMidSide(Vec value, typename Vec::Sample* const* channels, int sample) = delete;
+
+template <>
+inline FloatVec4 loadMidSide<FloatVec4>(const float* const* channels, int sample)
+{
+	const float left = channels[0][sample];
+	const float right = channels[1][sample];
+
+	return FloatVec4::set(0.5f * (left + right), 0.5f * (left - right), 0.0f, 0.0f);
+}
+
+template <>
+inline void storeMidSide<FloatVec4>(FloatVec4 value, float* const* channels, int sample)
+{
+	alignas(16) float lanes[FloatVec4::size];
+	value.store(lanes);
+
+	channels[0][sample] = lanes[0] + lanes[1];
+	channels[1][sample] = lanes[0] - lanes[1];
+}
+
+template <>
+inline DoubleVec2 loadMidSide<DoubleVec2>(const double* const* channels, int sample)
+{
+	const double left = channels[0][sample];
+	const double right = channels[1][sample];
+
+	return DoubleVec2::set(0.5 * (left + right), 0.5 * (left - right));
+}
+
+template <>
+inline void storeMidSide<DoubleVec2>(DoubleVec2 value, double* const* channels, int sample)
+{
+	alignas(16) double lanes[DoubleVec2::size];
+	value.store(lanes);
+
+	channels[0][sample] = lanes[0] + lanes[1];
+	channels[1][sample] = lanes[0] - lanes[1];
+}
+
+// Plain or mid/side loads and stores picked at compile time, so the mid/side
+// functions are only instantiated where a kernel really encodes the pair
+template <bool MidSide>
+struct ChannelIO
+{
+	template <typename Vec>
+	static Vec load(const typename Vec::Sample* const* channels, int numChannels, int sample)	{ return loadChannels<Vec>(channels, numChannels, sample); }
+
+	template <typename Vec>
+	static void store(Vec value, typename Vec::Sample* const* channels, int numChannels, int sample)	{ storeChannels(value, channels, numChannels, sample); }
+};
+
+template <>
+struct ChannelIO<true>
+{
+	template <typename Vec>
+	static Vec load(const typename Vec::Sample* const* channels, int, int sample)				{ return loadMidSide<Vec>(channels, sample); }
+
+	template <typename Vec>
+	static void store(Vec value, typename Vec::Sample* const* channels, int, int sample)		{ storeMidSide(value, channels, sample); }
+};
+
+//==============================================================================
+// Exponent bits for FastMath. powerOfTwo(n) is 2^n for a whole n in the normal
+// exponent range. splitExponent(x, exponent) takes a positive normal x and
+// returns its mantissa folded onto sqrt(1/2)..sqrt(2), x = mantissa * 2^exponent.
+template <typename Vec>
+inline Vec powerOfTwo(Vec n);
+
+template <typename Vec>
+inline Vec splitExponent(Vec x, Vec& exponent);
+
+template <>
+inline FloatVec1 powerOfTwo<FloatVec1>(FloatVec1 n)
+{
+	const uint32_t bits = (uint32_t)((int32_t)n.v + 127) << 23;
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return { value };
+}
+
+template <>
+inline FloatVec1 splitExponent<FloatVec1>(FloatVec1 x, FloatVec1& exponent)
+{
+	// Measured from sqrt(1/2), the exponent field carries into the next power where the mantissa passes sqrt(2)
+	uint32_t bits;
+	std::memcpy(&bits, &x.v, sizeof(bits));
+	const uint32_t offset = bits - 0x3f3504f3u;
+	exponent.v = (float)((int32_t)offset >> 23);
+
+	bits -= offset & 0xff800000u;
+	float mantissa;
+	std::memcpy(&mantissa, &bits, sizeof(mantissa));
+	return { mantissa };
+}
+
+template <>
+inline DoubleVec1 powerOfTwo<DoubleVec1>(DoubleVec1 n)
+{
+	const uint64_t bits = (uint64_t)((int64_t)n.v + 1023) << 52;
+	double value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return { value };
+}
+
+template <>
+inline DoubleVec1 splitExponent<DoubleVec1>(DoubleVec1 x, DoubleVec1& exponent)
+{
+	uint64_t bits;
+	std::memcpy(&bits, &x.v, sizeof(bits));
+	const uint64_t offset = bits - 0x3fe6a09e667f3bcdull;
+	exponent.v = (double)((int64_t)offset >> 52);
+
+	bits -= offset & 0xfff0000000000000ull;
+	double mantissa;
+	std::memcpy(&mantissa, &bits, sizeof(mantissa));
+	return { mantissa };
+}
+
+#if HARMONICS_SIMD_SSE
+template <>
+inline FloatVec4 powerOfTwo<FloatVec4>(FloatVec4 n)
+{
+	return { _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n.v), _mm_set1_epi32(127)), 23)) };
+}
+
+template <>
+inline FloatVec4 splitExponent<FloatVec4>(FloatVec4 x, FloatVec4& exponent)
+{
+	const __m128i bits = _mm_castps_si128(x.v);
+	const __m128i offset = _mm_sub_epi32(bits, _mm_set1_epi32(0x3f3504f3));
+	exponent.v = _mm_cvtepi32_ps(_mm_srai_epi32(offset, 23));
+
+	return { _mm_castsi128_ps(_mm_sub_epi32(bits, _mm_and_si128(offset, _mm_set1_epi32((int)0xff800000u)))) };
+}
+
+template <>
+inline DoubleVec2 powerOfTwo<DoubleVec2>(DoubleVec2 n)
+{
+	// The biased exponents go to the upper halves of the 64 bit lanes, then up to bit 52
+	const __m128i biased = _mm_add_epi32(_mm_cvtpd_epi32(n.v), _mm_set1_epi32(1023));
+	return { _mm_castsi128_pd(_mm_slli_epi64(_mm_unpacklo_epi32(_mm_setzero_si128(), biased), 20)) };
+}
+
+template <>
+inline DoubleVec2 splitExponent<DoubleVec2>(DoubleVec2 x, DoubleVec2& exponent)
+{
+	// No 64 bit arithmetic shift in SSE2, the exponent is shifted down from the upper halves
+	const __m128i bits = _mm_castpd_si128(x.v);
+	const __m128i offset = _mm_sub_epi64(bits, _mm_set1_epi64x(0x3fe6a09e667f3bcdll));
+	exponent.v = _mm_cvtepi32_pd(_mm_srai_epi32(_mm_shuffle_epi32(offset, _MM_SHUFFLE(3, 1, 3, 1)), 20));
+
+	return { _mm_castsi128_pd(_mm_sub_epi64(bits, _mm_and_si128(offset, _mm_set1_epi64x((long long)0xfff0000000000000ull)))) };
+}
+#elif HARMONICS_SIMD_NEON
+template <>
+inline FloatVec4 powerOfTwo<FloatVec4>(FloatVec4 n)
+{
+	return { vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n.v), vdupq_n_s32(127)), 23)) };
+}
+
+template <>
+inline FloatVec4 splitExponent<FloatVec4>(FloatVec4 x, FloatVec4& exponent)
+{
+	const int32x4_t bits = vreinterpretq_s32_f32(x.v);
+	const int32x4_t offset = vsubq_s32(bits, vdupq_n_s32(0x3f3504f3));
+	exponent.v = vcvtq_f32_s32(vshrq_n_s32(offset, 23));
+
+	return { vreinterpretq_f32_s32(vsubq_s32(bits, vandq_s32(offset, vdupq_n_s32((int)0xff800000u)))) };
+}
+#else
+template <>
+inline FloatVec4 powerOfTwo<FloatVec4>(FloatVec4 n)
+{
+	FloatVec4 result;
+
+	for (int lane = 0; lane < FloatVec4::size; ++lane)
+	{
+		result.v[lane] = powerOfTwo(FloatVec1 { n.v[lane] }).v;
+	}
+
+	return result;
+}
+
+template <>
+inline FloatVec4 splitExponent<FloatVec4>(FloatVec4 x, FloatVec4& exponent)
+{
+	FloatVec4 mantissa;
+
+	for (int lane = 0; lane < FloatVec4::size; ++lane)
+	{
+		FloatVec1 laneExponent;
+		mantissa.v[lane] = splitExponent(FloatVec1 { x.v[lane] }, laneExponent).v;
+		exponent.v[lane] = laneExponent.v;
+	}
+
+	return mantissa;
+}
+#endif
+
+#if HARMONICS_SIMD_NEON64
+template <>
+inline DoubleVec2 powerOfTwo<DoubleVec2>(DoubleVec2 n)
+{
+	return { vreinterpretq_f64_s64(vshlq_n_s64(vaddq_s64(vcvtq_s64_f64(n.v), vdupq_n_s64(1023)), 52)) };
+}
+
+template <>
+inline DoubleVec2 splitExponent<DoubleVec2>(DoubleVec2 x, DoubleVec2& exponent)
+{
+	const int64x2_t bits = vreinterpretq_s64_f64(x.v);
+	const int64x2_t offset = vsubq_s64(bits, vdupq_n_s64(0x3fe6a09e667f3bcdll));
+	exponent.v = vcvtq_f64_s64(vshrq_n_s64(offset, 52));
+
+	return { vreinterpretq_f64_s64(vsubq_s64(bits, vandq_s64(offset, vdupq_n_s64((int64_t)0xfff0000000000000ull)))) };
+}
+#elif ! HARMONICS_SIMD_SSE
+template <>
+inline DoubleVec2 powerOfTwo<DoubleVec2>(DoubleVec2 n)
+{
+	return { { powerOfTwo(DoubleVec1 { n.v[0] }).v, powerOfTwo(DoubleVec1 { n.v[1] }).v } };
+}
+
+template <>
+inline DoubleVec2 splitExponent<DoubleVec2>(DoubleVec2 x, DoubleVec2& exponent)
+{
+	DoubleVec1 first, second;
+	const double mantissa0 = splitExponent(DoubleVec1 { x.v[0] }, first).v;
+	const double mantissa1 = splitExponent(DoubleVec1 { x.v[1] }, second).v;
+
+	exponent = { { first.v, second.v } };
+	return { { mantissa0, mantissa1 } };
+}
+#endif
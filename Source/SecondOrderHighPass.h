@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    SecondOrderHighPass.h
+    Biquad highpass used as DC blocker after every squaring stage.
+    Coefficients and state are in the processing sample type, float or double.
+    The coefficients also carry the state variable form of the same filter,
+    the kernel topologies are in SecondOrderHighPassSIMD.h.
+
+    Cutoff and Q are automatable, so the coefficients are recomputed while
+    they move. The calculation uses FastTrig instead of libm, and
+    SecondOrderHighPassCache skips it while sample rate, cutoff and Q stay the
+    same.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include "FastTrig.h"
+
+//==============================================================================
+template <typename SampleType>
+struct SecondOrderHighPassCoefs
+{
+	SampleType a1 = SampleType(0);
+	SampleType a2 = SampleType(0);
+	SampleType b0 = SampleType(1);
+	SampleType b1 = SampleType(0);
+	SampleType b2 = SampleType(0);
+
+	// Same response as a state variable filter, g = tan(omega / 2), k = 1 / Q
+	// and h = 1 / (1 + g * (g + k)), see SecondOrderHighPassSIMD.h
+	SampleType svfG = SampleType(0);
+	SampleType svfK = SampleType(0);
+	SampleType svfH = SampleType(1);
+
+	static SecondOrderHighPassCoefs calculate(SampleType sampleRate, SampleType frequency, SampleType Q);
+};
+
+template <typename SampleType>
+inline SecondOrderHighPassCoefs<SampleType> SecondOrderHighPassCoefs<SampleType>::calculate(SampleType sampleRate, SampleType frequency, SampleType Q)
+{
+	const SampleType omega = frequency * (SampleType(2) * SampleType(3.141593) / sampleRate);
+
+	SampleType sn, cn;
+	FastTrig::sinCos(omega, sn, cn);
+
+	const SampleType alpha = sn / (SampleType(2) * Q);
+	const SampleType a0 = SampleType(1) + alpha;
+
+	SecondOrderHighPassCoefs coefs;
+	coefs.a1 = SampleType(-2) * cn;
+	coefs.a2 = SampleType(1) - alpha;
+
+	coefs.b0 = (1 + cn) / SampleType(2);
+	coefs.b1 = SampleType(-1) * (SampleType(1) + cn);
+	coefs.b2 = coefs.b0;
+
+	coefs.a1 /= a0;
+	coefs.a2 /= a0;
+
+	coefs.b0 /= a0;
+	coefs.b1 /= a0;
+	coefs.b2 /= a0;
+
+	// tan(omega / 2) from the same sine and cosine, 1 + cn stays near 2 for low cutoffs
+	coefs.svfG = sn / (SampleType(1) + cn);
+	coefs.svfK = SampleType(1) / Q;
+	coefs.svfH = SampleType(1) / (SampleType(1) + coefs.svfG * (coefs.svfG + coefs.svfK));
+
+	return coefs;
+}
+
+//==============================================================================
+// Coefficients of the last sample rate, cutoff and Q, one per processing chain,
+// every filter of the chain shares them
+template <typename SampleType>
+class SecondOrderHighPassCache
+{
+public:
+	// True when the coefficients were recomputed
+	bool update(SampleType sampleRate, SampleType frequency, SampleType Q);
+	void clear() { m_valid = false; };
+	bool isValid() const { return m_valid; };
+
+	const SecondOrderHighPassCoefs<SampleType>& getCoefs() const { return m_coefs; };
+
+protected:
+	SecondOrderHighPassCoefs<SampleType> m_coefs;
+
+	SampleType m_sampleRate = SampleType(0);
+	SampleType m_frequency = SampleType(0);
+	SampleType m_Q = SampleType(0);
+	bool m_valid = false;
+};
+
+template <typename SampleType>
+inline bool SecondOrderHighPassCache<SampleType>::update(SampleType sampleRate, SampleType frequency, SampleType Q)
+{
+	if (m_valid && sampleRate == m_sampleRate && frequency == m_frequency && Q == m_Q)
+	{
+		return false;
+	}
+
+	m_coefs = SecondOrderHighPassCoefs<SampleType>::calculate(sampleRate, frequency, Q);
+
+	m_sampleRate = sampleRate;
+	m_frequency = frequency;
+	m_Q = Q;
+	m_valid = true;
+
+	return true;
+}
+
+//==============================================================================
+template <typename SampleType>
+class SecondOrderHighPass
+{
+public:
+	SecondOrderHighPass() {};
+
+	void init(int sampleRate);
+	void setCoef(SampleType frequency, SampleType Q);
+	SampleType process(SampleType in);
+
+	const SecondOrderHighPassCoefs<SampleType>& getCoefs() const { return m_coefs; };
+
+protected:
+	SecondOrderHighPassCoefs<SampleType> m_coefs = { SampleType(-1.9928853477621913), SampleType(0.9964426738810956), SampleType(1.0), SampleType(-1.9928691659478477), SampleType(0.992901529576535) };
+	SampleType m_sampleRate = SampleType(0);
+
+	SampleType m_x1 = SampleType(0);
+	SampleType m_x2 = SampleType(0);
+	SampleType m_y1 = SampleType(0);
+	SampleType m_y2 = SampleType(0);
+};
+
+template <typename SampleType>
+inline void SecondOrderHighPass<SampleType>::init(int sampleRate)
+{
+	m_sampleRate = (SampleType)sampleRate;
+}
+
+template <typename SampleType>
+inline void SecondOrderHighPass<SampleType>::setCoef(SampleType frequency, SampleType Q)
+{
+	if (m_sampleRate == 0)
+	{
+		return;
+	}
+
+	m_coefs = SecondOrderHighPassCoefs<SampleType>::calculate(m_sampleRate, frequency, Q);
+}
+
+template <typename SampleType>
+inline SampleType SecondOrderHighPass<SampleType>::process(SampleType in)
+{
+	const SampleType y = m_coefs.b0 * in + m_coefs.b1 * m_x1 + m_coefs.b2 * m_x2 - m_coefs.a1 * m_y1 - m_coefs.a2 * m_y2;
+
+	m_y2 = m_y1;
+	m_y1 = y;
+	m_x2 = m_x1;
+	m_x1 = in;
+
+	return y;
+}
@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    SecondOrderHighPassSIMD.h
+    DC blocker of the kernel, one channel per SIMD lane, in three topologies
+    with the same frequency response:
+
+    - Direct Form I, the original biquad. Four states, the output depends on
+      the input through the whole five term sum.
+    - Transposed Direct Form II, two states, the input reaches the output
+      through one multiply-add. Shortest chain through a cascade, same
+      precision as Direct Form I.
+    - State variable (Zavalishin TPT / Cytomic SVF), two integrator states.
+      Its coefficients stay away from 1 where the biquad poles crowd at
+      z = 1, a few hundred to a few thousand times more accurate in float
+      at 20 Hz and high (oversampled) rates.
+
+    HARMONICS_HIGHPASS_TOPOLOGY picks the one the kernel uses. Direct Form I
+    stays the default, it is the only one bit-identical to the original loop
+    and to the golden checksums of HarmonicsBenchmark.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <initializer_list>
+
+#include "SIMDVector.h"
+#include "SecondOrderHighPass.h"
+
+#define HARMONICS_HIGHPASS_DF1 0
+#define HARMONICS_HIGHPASS_TDF2 1
+#define HARMONICS_HIGHPASS_SVF 2
+
+#ifndef HARMONICS_HIGHPASS_TOPOLOGY
+ #define HARMONICS_HIGHPASS_TOPOLOGY HARMONICS_HIGHPASS_DF1
+#endif
+
+//==============================================================================
+// Coefficients broadcast to every lane, one set is shared by all filters of a kernel
+template <typename Vec>
+struct SecondOrderHighPassSIMDCoefs
+{
+	using Sample = typename Vec::Sample;
+
+	Vec a1 = Vec::broadcast(Sample(0));
+	Vec a2 = Vec::broadcast(Sample(0));
+	Vec b0 = Vec::broadcast(Sample(1));
+	Vec b1 = Vec::broadcast(Sample(0));
+	Vec b2 = Vec::broadcast(Sample(0));
+
+	void set(const SecondOrderHighPassCoefs<Sample>& coefs)
+	{
+		a1 = Vec::broadcast(coefs.a1);
+		a2 = Vec::broadcast(coefs.a2);
+		b0 = Vec::broadcast(coefs.b0);
+		b1 = Vec::broadcast(coefs.b1);
+		b2 = Vec::broadcast(coefs.b2);
+	}
+};
+
+template <typename Vec>
+struct StateVariableHighPassSIMDCoefs
+{
+	using Sample = typename Vec::Sample;
+
+	Vec g = Vec::broadcast(Sample(0));
+	Vec damping = Vec::broadcast(Sample(0));
+	Vec h = Vec::broadcast(Sample(1));
+
+	void set(const SecondOrderHighPassCoefs<Sample>& coefs)
+	{
+		g = Vec::broadcast(coefs.svfG);
+		damping = Vec::broadcast(coefs.svfK + coefs.svfG);
+		h = Vec::broadcast(coefs.svfH);
+	}
+};
+
+//==============================================================================
+// True when every lane of every state is below threshold
+template <typename Vec>
+inline bool isStateDecayed(std::initializer_list<Vec> states, float threshold)
+{
+	using Sample = typename Vec::Sample;
+
+	for (const Vec& state : states)
+	{
+		alignas(16) Sample lanes[Vec::size];
+		state.store(lanes);
+
+		for (Sample value : lanes)
+		{
+			if (std::abs(value) >= threshold)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+//==============================================================================
+template <typename Vec>
+class DirectForm1HighPassSIMD
+{
+public:
+	using Sample = typename Vec::Sample;
+	using Coefs = SecondOrderHighPassSIMDCoefs<Vec>;
+
+	void reset() { *this = DirectForm1HighPassSIMD(); };
+	bool isDecayed(float threshold) const { return isStateDecayed({ m_x1, m_x2, m_y1, m_y2 }, threshold); };
+
+	Vec process(Vec in, const Coefs& coefs)
+	{
+		const Vec y = coefs.b0 * in + coefs.b1 * m_x1 + coefs.b2 * m_x2 - coefs.a1 * m_y1 - coefs.a2 * m_y2;
+
+		m_y2 = m_y1;
+		m_y1 = y;
+		m_x2 = m_x1;
+		m_x1 = in;
+
+		return y;
+	}
+
+protected:
+	Vec m_x1 = Vec::broadcast(Sample(0));
+	Vec m_x2 = Vec::broadcast(Sample(0));
+	Vec m_y1 = Vec::broadcast(Sample(0));
+	Vec m_y2 = Vec::broadcast(Sample(0));
+};
+
+//==============================================================================
+template <typename Vec>
+class TransposedDirectForm2HighPassSIMD
+{
+public:
+	using Sample = typename Vec::Sample;
+	using Coefs = SecondOrderHighPassSIMDCoefs<Vec>;
+
+	void reset() { *this = TransposedDirectForm2HighPassSIMD(); };
+	bool isDecayed(float threshold) const { return isStateDecayed({ m_s1, m_s2 }, threshold); };
+
+	Vec process(Vec in, const Coefs& coefs)
+	{
+		const Vec y = coefs.b0 * in + m_s1;
+
+		m_s1 = coefs.b1 * in - coefs.a1 * y + m_s2;
+		m_s2 = coefs.b2 * in - coefs.a2 * y;
+
+		return y;
+	}
+
+protected:
+	Vec m_s1 = Vec::broadcast(Sample(0));
+	Vec m_s2 = Vec::broadcast(Sample(0));
+};
+
+//==============================================================================
+template <typename Vec>
+class StateVariableHighPassSIMD
+{
+public:
+	using Sample = typename Vec::Sample;
+	using Coefs = StateVariableHighPassSIMDCoefs<Vec>;
+
+	void reset() { *this = StateVariableHighPassSIMD(); };
+	bool isDecayed(float threshold) const { return isStateDecayed({ m_band, m_low }, threshold); };
+
+	Vec process(Vec in, const Coefs& coefs)
+	{
+		const Vec high = coefs.h * (in - coefs.damping * m_band - m_low);
+
+		// Trapezoidal integrators, the state is the integrator output plus half a step
+		const Vec gHigh = coefs.g * high;
+		const Vec band = gHigh + m_band;
+		const Vec gBand = coefs.g * band;
+		const Vec low = gBand + m_low;
+
+		m_band = gHigh + band;
+		m_low = gBand + low;
+
+		return high;
+	}
+
+protected:
+	Vec m_band = Vec::broadcast(Sample(0));
+	Vec m_low = Vec::broadcast(Sample(0));
+};
+
+//==============================================================================
+#if HARMONICS_HIGHPASS_TOPOLOGY == HARMONICS_HIGHPASS_SVF
+template <typename Vec> using SecondOrderHighPassSIMD = StateVariableHighPassSIMD<Vec>;
+#elif HARMONICS_HIGHPASS_TOPOLOGY == HARMONICS_HIGHPASS_TDF2
+template <typename Vec> using SecondOrderHighPassSIMD = TransposedDirectForm2HighPassSIMD<Vec>;
+#else
+template <typename Vec> using SecondOrderHighPassSIMD = DirectForm1HighPassSIMD<Vec>;
+#endif
@@ -0,0 +1,349 @@
+/*
+  ==============================================================================
+
+    WorkerPool.h
+    Runs the tasks of one job on the calling thread and a few pre-spawned
+    worker threads, used to process independent channel groups in parallel.
+
+    The job is published through one atomic word holding the generation, the
+    task count and the next unclaimed task. Threads claim tasks with a
+    compare-exchange on it, so nothing locks or allocates, and a worker that
+    wakes up late can never claim a task of a newer job. The caller works on
+    its own job too and only spins on the remaining count for tasks a worker
+    has already claimed.
+
+    Idle workers spin with a pause instruction for SPIN_TIME_US after their
+    last job and then park on a semaphore. Publishing a job signals it once
+    for every parked worker, that takes no lock and only makes a system call
+    when someone is parked. Tasks no worker has claimed yet are simply run by
+    the caller, which then spins with a pause until the claimed ones are
+    done. One job runs at a time, a second caller (another plugin instance
+    sharing the pool) gets false back and runs its tasks itself.
+
+    Workers are spawned when the first user is added and stopped when the
+    last one is removed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64) || defined (_M_IX86)
+ #include <emmintrin.h>
+#elif defined (_M_ARM64) || defined (_M_ARM)
+ #include <intrin.h>
+#endif
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+ #endif
+ #include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <cerrno>
+ #include <semaphore.h>
+#endif
+
+//==============================================================================
+class WorkerPool
+{
+public:
+	static const int MAX_WORKERS = 7;
+
+	// Spin after a job before an idle worker parks, short against a block period
+	static const int SPIN_TIME_US = 50;
+	static const int STOP_TIMEOUT_MS = 100;
+
+	WorkerPool() {};
+	~WorkerPool();
+
+	// Message thread only. The first user spawns the workers, the last one stops them again
+	void addUser();
+	void removeUser();
+	int getNumWorkers() const { return m_numWorkers.load(); };
+
+	// Calls task(index) for every index below numTasks and returns once all are done.
+	// False without calling anything when the pool is busy or has no workers
+	template <typename Task>
+	bool run(int numTasks, Task& task);
+
+protected:
+	// Counting semaphore the idle workers park on, signal() never blocks
+	class Semaphore
+	{
+	public:
+		Semaphore();
+		~Semaphore();
+
+		void signal(int count);
+		void wait();
+
+	private:
+	   #if JUCE_WINDOWS
+		HANDLE m_handle;
+	   #elif JUCE_MAC || JUCE_IOS
+		dispatch_semaphore_t m_handle;
+	   #else
+		sem_t m_handle;
+	   #endif
+
+		JUCE_DECLARE_NON_COPYABLE(Semaphore)
+	};
+
+	class Worker : public juce::Thread
+	{
+	public:
+		Worker(WorkerPool& pool) : juce::Thread("Harmonics worker"), m_pool(pool) {};
+
+		void run() override;
+
+	private:
+		WorkerPool& m_pool;
+	};
+
+	// Generation in the upper 32 bits, task count and next task 16 bits each
+	static juce::uint64 pack(juce::uint32 generation, int numTasks, int next) { return ((juce::uint64)generation << 32) | ((juce::uint64)numTasks << 16) | (juce::uint64)next; };
+	static juce::uint32 getGeneration(juce::uint64 state) { return (juce::uint32)(state >> 32); };
+
+	void startWorkers();
+	void stopWorkers();
+
+	// Claims and runs tasks of this generation until none are left
+	void runTasks(juce::uint32 generation);
+
+	// Spin loop hint, lets the other hyper-thread run and saves power
+	static void pause();
+
+	std::atomic<juce::uint64> m_state { 0 };
+	std::atomic<int> m_remaining { 0 };
+	std::atomic<bool> m_busy { false };
+	juce::uint32 m_generation = 0;
+
+	// Current job, only read after a task of it was claimed
+	void* m_context = nullptr;
+	void (*m_invoke)(void* context, int task) = nullptr;
+
+	// Workers that may be parked, taken by the next job that signals them
+	std::atomic<int> m_parked { 0 };
+	Semaphore m_wake;
+
+	std::unique_ptr<Worker> m_workers[MAX_WORKERS];
+	std::atomic<int> m_numWorkers { 0 };
+	int m_numUsers = 0;
+	juce::CriticalSection m_userLock;
+};
+
+inline WorkerPool::~WorkerPool()
+{
+	stopWorkers();
+}
+
+inline void WorkerPool::addUser()
+{
+	const juce::ScopedLock lock(m_userLock);
+
+	if (m_numUsers++ == 0)
+	{
+		startWorkers();
+	}
+}
+
+inline void WorkerPool::removeUser()
+{
+	const juce::ScopedLock lock(m_userLock);
+	jassert(m_numUsers > 0);
+
+	if (--m_numUsers == 0)
+	{
+		stopWorkers();
+	}
+}
+
+inline void WorkerPool::startWorkers()
+{
+	const int numWorkers = juce::jlimit(0, MAX_WORKERS, juce::SystemStats::getNumCpus() - 1);
+
+	for (int index = 0; index < numWorkers; ++index)
+	{
+		m_workers[index].reset(new Worker(*this));
+
+		// JUCE 7.0.3 replaced the integer priorities
+	   #if JUCE_VERSION >= 0x070003
+		m_workers[index]->startRealtimeThread(juce::Thread::RealtimeOptions {});
+	   #else
+		m_workers[index]->startThread(juce::Thread::realtimeAudioPriority);
+	   #endif
+	}
+
+	m_numWorkers.store(numWorkers);
+}
+
+inline void WorkerPool::stopWorkers()
+{
+	// Holding the pool keeps a job from starting, one still running is waited for
+	while (m_busy.exchange(true, std::memory_order_acquire))
+	{
+		juce::Thread::yield();
+	}
+
+	const int numWorkers = m_numWorkers.exchange(0);
+
+	for (int index = 0; index < numWorkers; ++index)
+	{
+		m_workers[index]->signalThreadShouldExit();
+	}
+
+	// One wake-up for every worker, whether parked yet or not
+	m_wake.signal(numWorkers);
+
+	for (int index = 0; index < numWorkers; ++index)
+	{
+		m_workers[index]->stopThread(STOP_TIMEOUT_MS);
+		m_workers[index].reset();
+	}
+
+	m_parked.store(0);
+	m_busy.store(false, std::memory_order_release);
+}
+
+template <typename Task>
+inline bool WorkerPool::run(int numTasks, Task& task)
+{
+	if (numTasks > 0xffff || m_busy.exchange(true, std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	if (m_numWorkers.load() == 0)
+	{
+		m_busy.store(false, std::memory_order_release);
+		return false;
+	}
+
+	m_context = &task;
+	m_invoke = [](void* context, int index) { (*static_cast<Task*>(context))(index); };
+	m_remaining.store(numTasks, std::memory_order_relaxed);
+
+	const juce::uint32 generation = ++m_generation;
+	m_state.store(pack(generation, numTasks, 0));
+
+	// A worker counts itself before it checks the state a last time, so it either sees this job or is signalled
+	const int parked = m_parked.exchange(0);
+
+	if (parked > 0)
+	{
+		m_wake.signal(parked);
+	}
+
+	// Help with every task no spinning worker has taken, then wait for the claimed ones
+	runTasks(generation);
+
+	while (m_remaining.load(std::memory_order_acquire) > 0)
+	{
+		pause();
+	}
+
+	m_busy.store(false, std::memory_order_release);
+	return true;
+}
+
+inline void WorkerPool::runTasks(juce::uint32 generation)
+{
+	auto state = m_state.load(std::memory_order_acquire);
+
+	for (;;)
+	{
+		const int numTasks = (int)((state >> 16) & 0xffff);
+		const int next = (int)(state & 0xffff);
+
+		if (getGeneration(state) != generation || next >= numTasks)
+		{
+			return;
+		}
+
+		if (m_state.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel))
+		{
+			m_invoke(m_context, next);
+			m_remaining.fetch_sub(1, std::memory_order_release);
+			state = m_state.load(std::memory_order_acquire);
+		}
+	}
+}
+
+inline void WorkerPool::pause()
+{
+#if defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64) || defined (_M_IX86)
+	_mm_pause();
+#elif defined (__aarch64__) || defined (__arm__)
+	__asm__ __volatile__ ("yield");
+#elif defined (_M_ARM64) || defined (_M_ARM)
+	__yield();
+#endif
+}
+
+//==============================================================================
+#if JUCE_WINDOWS
+inline WorkerPool::Semaphore::Semaphore() : m_handle(CreateSemaphoreW(nullptr, 0, 0x7fffffff, nullptr)) {}
+inline WorkerPool::Semaphore::~Semaphore() { CloseHandle(m_handle); }
+inline void WorkerPool::Semaphore::signal(int count) { ReleaseSemaphore(m_handle, count, nullptr); }
+inline void WorkerPool::Semaphore::wait() { WaitForSingleObject(m_handle, INFINITE); }
+#elif JUCE_MAC || JUCE_IOS
+inline WorkerPool::Semaphore::Semaphore() : m_handle(dispatch_semaphore_create(0)) {}
+inline WorkerPool::Semaphore::~Semaphore() { dispatch_release(m_handle); }
+inline void WorkerPool::Semaphore::signal(int count) { while (--count >= 0) dispatch_semaphore_signal(m_handle); }
+inline void WorkerPool::Semaphore::wait() { dispatch_semaphore_wait(m_handle, DISPATCH_TIME_FOREVER); }
+#else
+inline WorkerPool::Semaphore::Semaphore() { sem_init(&m_handle, 0, 0); }
+inline WorkerPool::Semaphore::~Semaphore() { sem_destroy(&m_handle); }
+inline void WorkerPool::Semaphore::signal(int count) { while (--count >= 0) sem_post(&m_handle); }
+inline void WorkerPool::Semaphore::wait() { while (sem_wait(&m_handle) != 0 && errno == EINTR) {} }
+#endif
+
+//==============================================================================
+inline void WorkerPool::Worker::run()
+{
+	const auto spinTicks = juce::Time::getHighResolutionTicksPerSecond() * SPIN_TIME_US / 1000000;
+
+	juce::uint32 seen = getGeneration(m_pool.m_state.load());
+	auto idleSince = juce::Time::getHighResolutionTicks();
+
+	while (! threadShouldExit())
+	{
+		const auto generation = getGeneration(m_pool.m_state.load(std::memory_order_acquire));
+
+		if (generation != seen)
+		{
+			seen = generation;
+			m_pool.runTasks(generation);
+			idleSince = juce::Time::getHighResolutionTicks();
+		}
+		else if (juce::Time::getHighResolutionTicks() - idleSince < spinTicks)
+		{
+			pause();
+		}
+		else
+		{
+			m_pool.m_parked.fetch_add(1);
+
+			if (getGeneration(m_pool.m_state.load()) == seen)
+			{
+				m_pool.m_wake.wait();
+			}
+			else
+			{
+				// Leaves without parking. If the job has taken the count already, its signal wakes one worker for nothing
+				int parked = m_pool.m_parked.load();
+				while (parked > 0 && ! m_pool.m_parked.compare_exchange_weak(parked, parked - 1)) {}
+			}
+
+			idleSince = juce::Time::getHighResolutionTicks();
+		}
+	}
+}
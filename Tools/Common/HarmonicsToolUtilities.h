@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    HarmonicsToolUtilities.h
+    Parameter and profiling helpers shared by the offline tools.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+namespace HarmonicsTools
+{
+	inline juce::StringArray getParameterIDs(const juce::AudioProcessor& processor)
+	{
+		juce::StringArray parameterIDs;
+
+		for (auto* param : processor.getParameters())
+		{
+			if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param))
+			{
+				parameterIDs.add(ranged->getParameterID());
+			}
+		}
+
+		return parameterIDs;
+	}
+
+	// Plain value as shown to the user: dB, 0-1, on/off or the choice name
+	inline bool applyParameter(HarmonicsAudioProcessor& processor, const juce::String& id, const juce::String& text)
+	{
+		auto* param = processor.apvts.getParameter(id);
+
+		if (param == nullptr)
+		{
+			return false;
+		}
+
+		float value = text.getFloatValue();
+
+		if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(param))
+		{
+			const int index = choice->choices.indexOf(text, true);
+			value = (float)(index >= 0 ? index : text.getIntValue());
+		}
+		else if (dynamic_cast<juce::AudioParameterBool*>(param) != nullptr)
+		{
+			value = (text.equalsIgnoreCase("on") || text.equalsIgnoreCase("true") || text.getIntValue() != 0) ? 1.0f : 0.0f;
+		}
+
+		param->setValueNotifyingHost(param->convertTo0to1(value));
+		return true;
+	}
+
+	inline void applyParameters(HarmonicsAudioProcessor& processor, const juce::StringPairArray& parameters)
+	{
+		for (const auto& id : parameters.getAllKeys())
+		{
+			applyParameter(processor, id, parameters[id]);
+		}
+	}
+
+	// "ParameterID=value" lines or the plugin state XML, <PARAM id="..." value="..."/>
+	inline bool loadPreset(const juce::File& file, juce::StringPairArray& parameters)
+	{
+		if (! file.existsAsFile())
+		{
+			return false;
+		}
+
+		const auto text = file.loadFileAsString();
+
+		if (auto xml = juce::parseXML(text))
+		{
+			for (auto* param : xml->getChildWithTagNameIterator("PARAM"))
+			{
+				parameters.set(param->getStringAttribute("id"), param->getStringAttribute("value"));
+			}
+
+			return true;
+		}
+
+		juce::StringArray lines;
+		lines.addLines(text);
+
+		for (auto line : lines)
+		{
+			line = line.upToFirstOccurrenceOf("#", false, false).trim();
+
+			if (line.containsChar('='))
+			{
+				parameters.set(line.upToFirstOccurrenceOf("=", false, false).trim(), line.fromFirstOccurrenceOf("=", false, false).trim());
+			}
+		}
+
+		return true;
+	}
+
+	// processBlock timing of a processor as CSV columns, see ProcessProfiler
+	inline juce::String getProfileHeader()
+	{
+		juce::String header = "blocks,overloads,minUs,averageUs,p99Us,maxUs,averageLoad,p99Load,maxLoad";
+
+		for (int bin = 0; bin < ProcessProfiler::HISTOGRAM_BINS; ++bin)
+		{
+			header += ",load" + juce::String(10 * bin) + (bin == ProcessProfiler::HISTOGRAM_BINS - 1 ? "+" : "");
+		}
+
+		return header;
+	}
+
+	// Empty when HARMONICS_PROFILING is 0
+	inline juce::String getProfileColumns(const HarmonicsAudioProcessor& processor)
+	{
+		ProcessProfiler::Stats stats;
+
+		if (! processor.getProfiler().getStats(stats))
+		{
+			return {};
+		}
+
+		juce::String line = juce::String((juce::int64)stats.totalBlocks) + "," + juce::String((juce::int64)stats.overloads)
+			+ "," + juce::String(stats.minMicroseconds, 3) + "," + juce::String(stats.averageMicroseconds, 3)
+			+ "," + juce::String(stats.p99Microseconds, 3) + "," + juce::String(stats.maxMicroseconds, 3)
+			+ "," + juce::String(stats.averageLoad, 5) + "," + juce::String(stats.p99Load, 5) + "," + juce::String(stats.maxLoad, 5);
+
+		for (int count : stats.histogram)
+		{
+			line += "," + juce::String(count);
+		}
+
+		return line;
+	}
+}
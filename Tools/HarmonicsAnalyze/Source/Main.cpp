@@ -0,0 +1,544 @@
+/*
+  ==============================================================================
+
+    HarmonicsAnalyze
+    Offline harmonic content report, streams audio files through
+    HarmonicsAudioProcessor without writing audio and measures what the chain
+    adds. Files are analysed in parallel, one processor per file.
+
+    Files are read a block at a time, memory-mapped block by block when the
+    format supports it, so memory does not grow with the file length. Only
+    one row of levels per window is kept.
+
+    Per file, and per window with --window:
+      RMS of the 2nd, 4th, 6th and 8th harmonic (Classic engine)
+      RMS and peak of the harmonic sum before and after its clip
+      RMS and peak of the output before and after the limiter
+      Peak of the output
+      Samples the harmonic clip changed and their share of all samples
+      THD, RMS of the clipped harmonic sum over RMS of the chain input
+
+    Levels are summed over the channels. The harmonic ones are taken at the
+    kernel rate, the limiter ones at the host rate and weighted alike.
+
+    Usage:
+      HarmonicsAnalyze [options] <input files...>
+
+      --<ParameterID> <value>   Gain, Mix, Volume, Cutoff, Q, Button2..8, Oversampling,
+                                Engine, Harmonic2..16, Limiter, Lookahead, Mode, SideGain,
+                                SideMix, SideButton2..8, Envelope, Depth, Attack, Release
+      --preset <file>           "ParameterID=value" lines or a saved XML state,
+                                command line values override the preset
+      --window <seconds>        Length of the report windows, default 0 for whole files
+      --csv <file>              Writes one row per file or window as CSV
+      --json <file>             Writes the same as JSON
+      --threads <n>             Default is the number of CPU cores
+      --block <samples>         Processing block size, default 65536
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Common/HarmonicsToolUtilities.h"
+
+#include <iostream>
+#include <mutex>
+
+//==============================================================================
+struct AnalyzeSettings
+{
+	juce::StringPairArray parameters;
+	double windowSeconds = 0.0;
+	juce::File csvFile;
+	juce::File jsonFile;
+	int threads = juce::SystemStats::getNumCpus();
+	int blockSize = 65536;
+};
+
+// Meter sums of one window, in double so hours of audio do not lose precision
+struct AnalyzeLevels
+{
+	double sumSquares[HarmonicsMeter::numLevels] = {};
+	float peak[HarmonicsMeter::numLevels] = {};
+	double driveSumSquares = 0.0;
+	juce::int64 clipped = 0;
+	juce::int64 meterSamples = 0;
+	float outputPeak = 0.0f;
+
+	void add(const HarmonicsMeter& meter)
+	{
+		for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+		{
+			sumSquares[level] += (double)meter.sumSquares[level];
+			peak[level] = juce::jmax(peak[level], meter.peak[level]);
+		}
+
+		driveSumSquares += (double)meter.driveSumSquares;
+		clipped += meter.clipped;
+		meterSamples += meter.samples;
+	}
+
+	void add(const AnalyzeLevels& other)
+	{
+		for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+		{
+			sumSquares[level] += other.sumSquares[level];
+			peak[level] = juce::jmax(peak[level], other.peak[level]);
+		}
+
+		driveSumSquares += other.driveSumSquares;
+		clipped += other.clipped;
+		meterSamples += other.meterSamples;
+		outputPeak = juce::jmax(outputPeak, other.outputPeak);
+	}
+
+	double getRMS(int level) const
+	{
+		return meterSamples > 0 ? std::sqrt(sumSquares[level] / (double)meterSamples) : 0.0;
+	}
+
+	// Silent input has no distortion
+	double getTHD() const
+	{
+		return driveSumSquares > 0.0 ? std::sqrt(sumSquares[HarmonicsMeter::clippedHarmonics] / driveSumSquares) : 0.0;
+	}
+
+	double getClipRate() const
+	{
+		return meterSamples > 0 ? (double)clipped / (double)meterSamples : 0.0;
+	}
+};
+
+struct FileAnalysis
+{
+	juce::File file;
+	bool analysed = false;
+	double sampleRate = 0.0;
+	juce::int64 length = 0;
+	juce::int64 windowSamples = 0;
+	std::vector<AnalyzeLevels> windows;
+};
+
+static std::mutex s_consoleLock;
+
+static void printLine(const juce::String& text)
+{
+	std::lock_guard<std::mutex> lock(s_consoleLock);
+	std::cout << text << std::endl;
+}
+
+static juce::String toDecibels(double gain)
+{
+	return juce::String(juce::Decibels::gainToDecibels(gain, -144.0), 2);
+}
+
+static AnalyzeLevels getTotal(const FileAnalysis& analysis)
+{
+	AnalyzeLevels total;
+
+	for (const auto& levels : analysis.windows)
+	{
+		total.add(levels);
+	}
+
+	return total;
+}
+
+//==============================================================================
+static bool analyzeFile(FileAnalysis& analysis, const AnalyzeSettings& settings)
+{
+	const auto& inputFile = analysis.file;
+
+	juce::AudioFormatManager formatManager;
+	formatManager.registerBasicFormats();
+
+	// Memory-mapped where the format allows it, mapping only the block being read
+	std::unique_ptr<juce::AudioFormatReader> reader;
+	juce::MemoryMappedAudioFormatReader* mappedReader = nullptr;
+
+	if (auto* format = formatManager.findFormatForFileExtension(inputFile.getFileExtension()))
+	{
+		if (auto* mapped = format->createMemoryMappedReader(inputFile))
+		{
+			reader.reset(mapped);
+			mappedReader = mapped;
+		}
+	}
+
+	if (reader == nullptr)
+	{
+		reader.reset(formatManager.createReaderFor(inputFile));
+	}
+
+	if (reader == nullptr)
+	{
+		printLine("Cannot read " + inputFile.getFullPathName());
+		return false;
+	}
+
+	const int channels = (int)reader->numChannels;
+	const double sampleRate = reader->sampleRate;
+	const juce::int64 length = reader->lengthInSamples;
+
+	// Processor, summing the levels of every block
+	HarmonicsAudioProcessor processor;
+
+	HarmonicsTools::applyParameters(processor, settings.parameters);
+
+	processor.setNonRealtime(true);
+	processor.setOfflineMetering(true);
+	processor.setPlayConfigDetails(channels, channels, sampleRate, settings.blockSize);
+
+	if (processor.getTotalNumOutputChannels() != channels)
+	{
+		printLine("Unsupported channel count " + juce::String(channels) + " in " + inputFile.getFullPathName());
+		return false;
+	}
+
+	processor.prepareToPlay(sampleRate, settings.blockSize);
+
+	// One window for the whole file without --window
+	const juce::int64 windowSamples = settings.windowSeconds > 0.0
+		? juce::jlimit((juce::int64)1, juce::jmax((juce::int64)1, length), (juce::int64)std::llround(settings.windowSeconds * sampleRate))
+		: juce::jmax((juce::int64)1, length);
+	const juce::int64 numWindows = juce::jmax((juce::int64)1, (length + windowSamples - 1) / windowSamples);
+
+	analysis.sampleRate = sampleRate;
+	analysis.length = length;
+	analysis.windowSamples = windowSamples;
+	analysis.windows.assign((size_t)numWindows, AnalyzeLevels());
+
+	// Blocks end on window boundaries, the latency is flushed with silence at the end.
+	// Levels belong to the window of the input samples, output peaks to the window they are delayed from
+	const int latency = processor.getLatencySamples();
+	const juce::int64 totalSamples = length + latency;
+
+	juce::AudioBuffer<float> buffer(channels, settings.blockSize);
+	juce::MidiBuffer midi;
+
+	const double startTime = juce::Time::getMillisecondCounterHiRes();
+
+	for (juce::int64 position = 0; position < totalSamples; )
+	{
+		juce::int64 end = juce::jmin(position + settings.blockSize, totalSamples);
+
+		if (position < length)
+		{
+			end = juce::jmin(end, (position / windowSamples + 1) * windowSamples);
+		}
+
+		const int samples = (int)(end - position);
+		const int inputSamples = (int)juce::jlimit((juce::int64)0, (juce::int64)samples, length - position);
+
+		buffer.setSize(channels, samples, false, false, true);
+		buffer.clear();
+
+		if (inputSamples > 0)
+		{
+			if (mappedReader != nullptr && ! mappedReader->mapSectionOfFile({ position, position + inputSamples }))
+			{
+				printLine("Cannot map " + inputFile.getFullPathName());
+				return false;
+			}
+
+			reader->read(&buffer, 0, inputSamples, position, true, true);
+		}
+
+		processor.processBlock(buffer, midi);
+
+		const juce::int64 window = juce::jmin(position / windowSamples, numWindows - 1);
+		analysis.windows[(size_t)window].add(processor.takeOfflineMeter());
+
+		// Output positions past the latency map back to input positions, which may cross a window boundary
+		for (juce::int64 output = juce::jmax(position, (juce::int64)latency); output < end && output - latency < length; )
+		{
+			const juce::int64 outputWindow = (output - latency) / windowSamples;
+			const juce::int64 outputEnd = juce::jmin(end, latency + juce::jmin((outputWindow + 1) * windowSamples, length));
+
+			auto& levels = analysis.windows[(size_t)outputWindow];
+			levels.outputPeak = juce::jmax(levels.outputPeak, buffer.getMagnitude((int)(output - position), (int)(outputEnd - output)));
+
+			output = outputEnd;
+		}
+
+		position = end;
+	}
+
+	processor.releaseResources();
+
+	const auto total = getTotal(analysis);
+	const double seconds = 0.001 * (juce::Time::getMillisecondCounterHiRes() - startTime);
+	const double realtime = seconds > 0.0 ? (double)length / sampleRate / seconds : 0.0;
+
+	printLine(inputFile.getFileName() + ": THD " + juce::String(100.0 * total.getTHD(), 3) + " %, clipped " + juce::String(100.0 * total.getClipRate(), 3)
+		+ " %, output peak " + toDecibels(total.outputPeak) + " dB (" + juce::String(realtime, 1) + "x realtime)");
+
+	analysis.analysed = true;
+	return true;
+}
+
+//==============================================================================
+// Rows of the report, one per window or one per file
+static const char* const s_levelNames[HarmonicsMeter::numLevels] = { "h2", "h4", "h6", "h8", "harmonics", "clipped_harmonics", "pre_limiter", "post_limiter" };
+
+static AnalyzeLevels getRowLevels(const FileAnalysis& analysis, int window, bool perWindow)
+{
+	return perWindow ? analysis.windows[(size_t)window] : getTotal(analysis);
+}
+
+static juce::String getCSVHeader()
+{
+	juce::StringArray columns { "file", "start_s", "end_s" };
+
+	for (const auto* name : s_levelNames)
+	{
+		columns.add(juce::String(name) + "_rms_db");
+		columns.add(juce::String(name) + "_peak_db");
+	}
+
+	columns.add("output_peak_db");
+	columns.add("clipped_samples");
+	columns.add("clip_rate_percent");
+	columns.add("thd_percent");
+	columns.add("thd_db");
+
+	return columns.joinIntoString(",");
+}
+
+static void writeCSV(const juce::File& file, const std::vector<FileAnalysis>& analyses, bool perWindow)
+{
+	juce::StringArray lines;
+	lines.add(getCSVHeader());
+
+	for (const auto& analysis : analyses)
+	{
+		const int rows = analysis.analysed ? (perWindow ? (int)analysis.windows.size() : 1) : 0;
+
+		for (int row = 0; row < rows; ++row)
+		{
+			const auto levels = getRowLevels(analysis, row, perWindow);
+			const juce::int64 start = perWindow ? row * analysis.windowSamples : 0;
+			const juce::int64 end = perWindow ? juce::jmin(start + analysis.windowSamples, analysis.length) : analysis.length;
+
+			juce::StringArray columns { analysis.file.getFileName().quoted(), juce::String((double)start / analysis.sampleRate, 3), juce::String((double)end / analysis.sampleRate, 3) };
+
+			for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+			{
+				columns.add(toDecibels(levels.getRMS(level)));
+				columns.add(toDecibels(levels.peak[level]));
+			}
+
+			columns.add(toDecibels(levels.outputPeak));
+			columns.add(juce::String(levels.clipped));
+			columns.add(juce::String(100.0 * levels.getClipRate(), 4));
+			columns.add(juce::String(100.0 * levels.getTHD(), 4));
+			columns.add(toDecibels(levels.getTHD()));
+
+			lines.add(columns.joinIntoString(","));
+		}
+	}
+
+	file.replaceWithText(lines.joinIntoString("\n") + "\n");
+}
+
+static void writeJSON(const juce::File& file, const std::vector<FileAnalysis>& analyses, bool perWindow)
+{
+	juce::Array<juce::var> files;
+
+	for (const auto& analysis : analyses)
+	{
+		if (! analysis.analysed)
+		{
+			continue;
+		}
+
+		juce::Array<juce::var> rows;
+
+		for (int row = 0; row < (perWindow ? (int)analysis.windows.size() : 1); ++row)
+		{
+			const auto levels = getRowLevels(analysis, row, perWindow);
+			const juce::int64 start = perWindow ? row * analysis.windowSamples : 0;
+			const juce::int64 end = perWindow ? juce::jmin(start + analysis.windowSamples, analysis.length) : analysis.length;
+
+			juce::DynamicObject::Ptr object = new juce::DynamicObject();
+			object->setProperty("start_s", (double)start / analysis.sampleRate);
+			object->setProperty("end_s", (double)end / analysis.sampleRate);
+
+			for (int level = 0; level < HarmonicsMeter::numLevels; ++level)
+			{
+				object->setProperty(juce::String(s_levelNames[level]) + "_rms_db", juce::Decibels::gainToDecibels(levels.getRMS(level), -144.0));
+				object->setProperty(juce::String(s_levelNames[level]) + "_peak_db", juce::Decibels::gainToDecibels((double)levels.peak[level], -144.0));
+			}
+
+			object->setProperty("output_peak_db", juce::Decibels::gainToDecibels((double)levels.outputPeak, -144.0));
+			object->setProperty("clipped_samples", levels.clipped);
+			object->setProperty("clip_rate_percent", 100.0 * levels.getClipRate());
+			object->setProperty("thd_percent", 100.0 * levels.getTHD());
+			object->setProperty("thd_db", juce::Decibels::gainToDecibels(levels.getTHD(), -144.0));
+
+			rows.add(juce::var(object.get()));
+		}
+
+		juce::DynamicObject::Ptr object = new juce::DynamicObject();
+		object->setProperty("file", analysis.file.getFullPathName());
+		object->setProperty("sample_rate", analysis.sampleRate);
+		object->setProperty(perWindow ? "windows" : "total", perWindow ? juce::var(rows) : rows[0]);
+
+		files.add(juce::var(object.get()));
+	}
+
+	file.replaceWithText(juce::JSON::toString(juce::var(files)) + "\n");
+}
+
+//==============================================================================
+static void printUsage()
+{
+	std::cout << "Usage: HarmonicsAnalyze [options] <input files...>" << std::endl
+			  << "  --<ParameterID> <value>  Gain, Mix, Volume, Cutoff, Q, Button2, Button4, Button6, Button8," << std::endl
+			  << "                           Oversampling, Engine (Classic, Chebyshev), Harmonic2 ... Harmonic16," << std::endl
+			  << "                           Limiter (on, off), Lookahead (0.5 ms, 1 ms, 2 ms, 5 ms)," << std::endl
+			  << "                           Mode (Stereo, Mid/Side), SideGain, SideMix, SideButton2 ... SideButton8," << std::endl
+			  << "                           Envelope (on, off), Depth, Attack, Release (ms)" << std::endl
+			  << "  --preset <file>          \"ParameterID=value\" lines or a saved XML state" << std::endl
+			  << "  --window <seconds>       Report windows of this length, default 0 for whole files" << std::endl
+			  << "  --csv <file>             Write the report as CSV" << std::endl
+			  << "  --json <file>            Write the report as JSON" << std::endl
+			  << "  --threads <n>            Parallel files, default number of CPU cores" << std::endl
+			  << "  --block <samples>        Processing block size, default 65536" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+	AnalyzeSettings settings;
+	juce::StringPairArray commandLineParameters;
+	juce::Array<juce::File> inputFiles;
+
+	// Parameter IDs known by the processor
+	const auto parameterIDs = HarmonicsTools::getParameterIDs(HarmonicsAudioProcessor());
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const juce::String arg(argv[i]);
+
+		if (arg == "--help" || arg == "-h")
+		{
+			printUsage();
+			return 0;
+		}
+
+		if (! arg.startsWith("--"))
+		{
+			inputFiles.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+			continue;
+		}
+
+		if (i + 1 >= argc)
+		{
+			std::cout << "Missing value for " << arg << std::endl;
+			return 1;
+		}
+
+		const juce::String option = arg.substring(2);
+		const juce::String value(argv[++i]);
+
+		if (option == "preset")
+		{
+			if (! HarmonicsTools::loadPreset(juce::File::getCurrentWorkingDirectory().getChildFile(value), settings.parameters))
+			{
+				std::cout << "Cannot read preset " << value << std::endl;
+				return 1;
+			}
+		}
+		else if (option == "window")
+		{
+			settings.windowSeconds = juce::jmax(0.0, value.getDoubleValue());
+		}
+		else if (option == "csv")
+		{
+			settings.csvFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+		}
+		else if (option == "json")
+		{
+			settings.jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+		}
+		else if (option == "threads")
+		{
+			settings.threads = juce::jmax(1, value.getIntValue());
+		}
+		else if (option == "block")
+		{
+			settings.blockSize = juce::jmax(16, value.getIntValue());
+		}
+		else if (parameterIDs.contains(option, true))
+		{
+			commandLineParameters.set(parameterIDs[parameterIDs.indexOf(option, true)], value);
+		}
+		else
+		{
+			std::cout << "Unknown option " << arg << std::endl;
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (inputFiles.isEmpty())
+	{
+		printUsage();
+		return 1;
+	}
+
+	// Command line overrides the preset
+	settings.parameters.addArray(commandLineParameters);
+
+	// A slot per file, the report keeps the command line order
+	std::vector<FileAnalysis> analyses((size_t)inputFiles.size());
+
+	for (int i = 0; i < inputFiles.size(); ++i)
+	{
+		analyses[(size_t)i].file = inputFiles[i];
+	}
+
+	std::atomic<int> failed { 0 };
+	const double startTime = juce::Time::getMillisecondCounterHiRes();
+
+	{
+		juce::ThreadPool pool(juce::jmin(settings.threads, inputFiles.size()));
+
+		for (auto& analysis : analyses)
+		{
+			pool.addJob([&analysis, &settings, &failed]
+			{
+				if (! analyzeFile(analysis, settings))
+				{
+					++failed;
+				}
+			});
+		}
+
+		while (pool.getNumJobs() > 0)
+		{
+			juce::Thread::sleep(20);
+		}
+	}
+
+	const double seconds = 0.001 * (juce::Time::getMillisecondCounterHiRes() - startTime);
+	const bool perWindow = settings.windowSeconds > 0.0;
+
+	if (settings.csvFile != juce::File())
+	{
+		writeCSV(settings.csvFile, analyses, perWindow);
+		std::cout << "Wrote CSV to " << settings.csvFile.getFullPathName() << std::endl;
+	}
+
+	if (settings.jsonFile != juce::File())
+	{
+		writeJSON(settings.jsonFile, analyses, perWindow);
+		std::cout << "Wrote JSON to " << settings.jsonFile.getFullPathName() << std::endl;
+	}
+
+	std::cout << "Analysed " << (inputFiles.size() - failed) << " of " << inputFiles.size() << " files in " << juce::String(seconds, 2) << " s" << std::endl;
+
+	return failed > 0 ? 1 : 0;
+}
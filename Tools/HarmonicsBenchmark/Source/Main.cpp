@@ -0,0 +1,814 @@
+/*
+  ==============================================================================
+
+    HarmonicsBenchmark
+    Times SecondOrderHighPass::process and HarmonicsAudioProcessor::processBlock
+    in float and double over block sizes, sample rates, channel counts, all
+    16 button combinations and the Chebyshev engine, and checks the processed audio against golden
+    checksums. The df1/tdf2/svf-chain kinds time four cascaded DC blockers of
+    each kernel topology on one channel, the serial chain the kernel runs.
+
+    Usage:
+      HarmonicsBenchmark [options]
+
+      --blocks <list>           Block sizes, default 16,32,64,128,256,512,1024,2048,4096
+      --rates <list>            Sample rates, default 44100,48000,88200,96000,176400,192000
+      --channels <list>         Channel counts, default 1,2,6,16
+      --masks <list>            Button masks 0-15, bit 0 = Button2 ... bit 3 = Button8,
+                                16 = Chebyshev engine with all harmonics, default all
+      --oversampling <list>     Oversampling choices 0-3, default 0
+      --precision <list>        32 and/or 64 bit processing, default 32,64
+      --seconds <value>         Audio seconds per case, default 1
+      --csv <file>              Writes the results as CSV
+      --compare <file>          Prints the speedup against a CSV written by an earlier build
+      --profile <file>          Writes the processor's own processBlock timing per case as CSV
+      --write-golden <file>     Renders the golden cases and writes their checksums
+      --check-golden <file>     Renders the golden cases and compares them, exit code 1 on mismatch
+      --check-parallel          Renders 16 channels serially and on the worker pool, exit code 1
+                                unless both are bit-identical
+      --check-state             Round-trips every preset through the binary state and the old
+                                XML state, prints the save and load times, exit code 1 on mismatch
+
+    Lists are comma separated.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Common/HarmonicsToolUtilities.h"
+#include "../../../Source/SecondOrderHighPass.h"
+#include "../../../Source/SecondOrderHighPassSIMD.h"
+
+#include <iostream>
+#include <map>
+#include <type_traits>
+
+//==============================================================================
+struct BenchmarkSettings
+{
+	juce::Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+	juce::Array<int> sampleRates { 44100, 48000, 88200, 96000, 176400, 192000 };
+	juce::Array<int> channels { 1, 2, 6, 16 };
+	juce::Array<int> masks { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+	juce::Array<int> oversampling { 0 };
+	juce::Array<int> precisions { 32, 64 };
+	double seconds = 1.0;
+};
+
+struct BenchmarkResult
+{
+	juce::String kind;
+	int precision = 32;
+	int channels = 0;
+	int sampleRate = 0;
+	int blockSize = 0;
+	int mask = 0;
+	int oversampling = 0;
+
+	double nsPerSample = 0.0;		// Per channel sample at the base rate
+	double realtimeFactor = 0.0;
+
+	// ProcessProfiler columns, processor cases only
+	juce::String profile;
+
+	juce::String getKey() const
+	{
+		return kind + "," + juce::String(precision) + "," + juce::String(channels) + "," + juce::String(sampleRate) + "," + juce::String(blockSize) + ","
+			+ juce::String(mask) + "," + juce::String(oversampling);
+	}
+};
+
+static const char* const csvHeader = "kind,precision,channels,sampleRate,blockSize,mask,oversampling,nsPerSample,realtimeFactor";
+
+//==============================================================================
+static volatile float s_sink = 0.0f;
+
+static double getSeconds()
+{
+	return (double)juce::Time::getHighResolutionTicks() / (double)juce::Time::getHighResolutionTicksPerSecond();
+}
+
+// Seeded noise over two sines, libm differences between platforms break the hash but not the RMS check
+template <typename SampleType>
+static void fillTestSignal(juce::AudioBuffer<SampleType>& buffer, int sampleRate)
+{
+	juce::Random random(0x4861726d);
+
+	for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+	{
+		SampleType* data = buffer.getWritePointer(channel);
+		const double frequency = 110.0 * (channel + 1);
+
+		for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+		{
+			const double phase = (double)(sample % sampleRate) / (double)sampleRate;
+			data[sample] = (SampleType)(0.5f * (float)std::sin(2.0 * juce::MathConstants<double>::pi * frequency * phase) + 0.1f * (random.nextFloat() - 0.5f));
+		}
+	}
+}
+
+// Past the button masks, same numbering as the kernel variants
+static const int chebyshevMask = 16;
+
+static void applyMask(HarmonicsAudioProcessor& processor, int mask, float chebyshevLevel = 0.05f)
+{
+	// Every harmonic up to the 16th, the worst case polynomial degree
+	HarmonicsTools::applyParameter(processor, "Engine", mask == chebyshevMask ? "Chebyshev" : "Classic");
+
+	for (int harmonic = 2; harmonic <= ChebyshevLevels::maxHarmonic; ++harmonic)
+	{
+		HarmonicsTools::applyParameter(processor, HarmonicsAudioProcessor::getHarmonicParameterID(harmonic), juce::String(mask == chebyshevMask ? chebyshevLevel : 0.0f));
+	}
+
+	HarmonicsTools::applyParameter(processor, "Button2", (mask & 1) ? "on" : "off");
+	HarmonicsTools::applyParameter(processor, "Button4", (mask & 2) ? "on" : "off");
+	HarmonicsTools::applyParameter(processor, "Button6", (mask & 4) ? "on" : "off");
+	HarmonicsTools::applyParameter(processor, "Button8", (mask & 8) ? "on" : "off");
+}
+
+//==============================================================================
+template <typename SampleType>
+static BenchmarkResult benchmarkHighPass(int sampleRate, int blockSize, double seconds)
+{
+	BenchmarkResult result;
+	result.kind = "highpass";
+	result.precision = 8 * (int)sizeof(SampleType);
+	result.channels = 1;
+	result.sampleRate = sampleRate;
+	result.blockSize = blockSize;
+
+	juce::AudioBuffer<SampleType> source(1, sampleRate);
+	fillTestSignal(source, sampleRate);
+
+	SecondOrderHighPass<SampleType> filter;
+	filter.init(sampleRate);
+	filter.setCoef(SampleType(20), SampleType(0.7));
+
+	std::vector<SampleType> block(blockSize);
+	const juce::int64 totalSamples = juce::jmax((juce::int64)blockSize, (juce::int64)(seconds * sampleRate));
+
+	double elapsed = 0.0;
+	SampleType sink = SampleType(0);
+
+	for (juce::int64 position = 0; position < totalSamples; position += blockSize)
+	{
+		const int offset = (int)(position % (sampleRate - blockSize));
+		std::copy(source.getReadPointer(0, offset), source.getReadPointer(0, offset) + blockSize, block.begin());
+
+		const double start = getSeconds();
+
+		for (auto& sample : block)
+		{
+			sample = filter.process(sample);
+		}
+
+		elapsed += getSeconds() - start;
+		sink += block[0];
+	}
+
+	// Keeps the loop from being optimized away
+	s_sink = (float)sink;
+
+	const juce::int64 processed = ((totalSamples + blockSize - 1) / blockSize) * blockSize;
+	result.nsPerSample = 1e9 * elapsed / (double)processed;
+	result.realtimeFactor = elapsed > 0.0 ? (double)processed / sampleRate / elapsed : 0.0;
+	return result;
+}
+
+// Four filters in series like the 2nd to 8th harmonic stages, one lane so the dependency chain sets the speed
+template <typename SampleType, template <typename> class Filter>
+static BenchmarkResult benchmarkCascade(const juce::String& kind, int sampleRate, int blockSize, double seconds)
+{
+	using Vec = typename std::conditional<std::is_same<SampleType, double>::value, DoubleVec1, FloatVec1>::type;
+
+	BenchmarkResult result;
+	result.kind = kind;
+	result.precision = 8 * (int)sizeof(SampleType);
+	result.channels = 1;
+	result.sampleRate = sampleRate;
+	result.blockSize = blockSize;
+
+	juce::AudioBuffer<SampleType> source(1, sampleRate);
+	fillTestSignal(source, sampleRate);
+
+	typename Filter<Vec>::Coefs coefs;
+	coefs.set(SecondOrderHighPassCoefs<SampleType>::calculate((SampleType)sampleRate, SampleType(20), SampleType(0.7)));
+
+	Filter<Vec> filters[4];
+
+	std::vector<SampleType> block(blockSize);
+	const juce::int64 totalSamples = juce::jmax((juce::int64)blockSize, (juce::int64)(seconds * sampleRate));
+
+	double elapsed = 0.0;
+	SampleType sink = SampleType(0);
+
+	for (juce::int64 position = 0; position < totalSamples; position += blockSize)
+	{
+		const int offset = (int)(position % (sampleRate - blockSize));
+		std::copy(source.getReadPointer(0, offset), source.getReadPointer(0, offset) + blockSize, block.begin());
+
+		const double start = getSeconds();
+
+		for (auto& sample : block)
+		{
+			Vec x = Vec::load(&sample);
+
+			for (auto& filter : filters)
+			{
+				x = filter.process(x, coefs);
+			}
+
+			x.store(&sample);
+		}
+
+		elapsed += getSeconds() - start;
+		sink += block[0];
+	}
+
+	s_sink = (float)sink;
+
+	const juce::int64 processed = ((totalSamples + blockSize - 1) / blockSize) * blockSize;
+	result.nsPerSample = 1e9 * elapsed / (double)processed;
+	result.realtimeFactor = elapsed > 0.0 ? (double)processed / sampleRate / elapsed : 0.0;
+	return result;
+}
+
+template <typename SampleType>
+static BenchmarkResult benchmarkProcessor(int channels, int sampleRate, int blockSize, int mask, int oversampling, double seconds)
+{
+	BenchmarkResult result;
+	result.kind = "processor";
+	result.precision = 8 * (int)sizeof(SampleType);
+	result.channels = channels;
+	result.sampleRate = sampleRate;
+	result.blockSize = blockSize;
+	result.mask = mask;
+	result.oversampling = oversampling;
+
+	HarmonicsAudioProcessor processor;
+	applyMask(processor, mask);
+	HarmonicsTools::applyParameter(processor, "Oversampling", juce::String(oversampling));
+
+	processor.setNonRealtime(true);
+	processor.setPlayConfigDetails(channels, channels, sampleRate, blockSize);
+	processor.setProcessingPrecision(sizeof(SampleType) == sizeof(double) ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+
+	if (processor.getTotalNumOutputChannels() != channels)
+	{
+		return result;
+	}
+
+	processor.prepareToPlay(sampleRate, blockSize);
+
+	juce::AudioBuffer<SampleType> source(channels, sampleRate);
+	fillTestSignal(source, sampleRate);
+
+	juce::AudioBuffer<SampleType> buffer(channels, blockSize);
+	juce::MidiBuffer midi;
+
+	const juce::int64 totalSamples = juce::jmax((juce::int64)blockSize, (juce::int64)(seconds * sampleRate));
+	const juce::int64 warmUpSamples = juce::jmin(totalSamples, (juce::int64)sampleRate / 10);
+
+	double elapsed = 0.0;
+	juce::int64 processed = 0;
+
+	for (juce::int64 position = -warmUpSamples; position < totalSamples; position += blockSize)
+	{
+		const int offset = (int)((position + warmUpSamples) % (sampleRate - blockSize));
+
+		for (int channel = 0; channel < channels; ++channel)
+		{
+			buffer.copyFrom(channel, 0, source, channel, offset, blockSize);
+		}
+
+		const double start = getSeconds();
+		processor.processBlock(buffer, midi);
+		const double stop = getSeconds();
+
+		if (position >= 0)
+		{
+			elapsed += stop - start;
+			processed += blockSize;
+		}
+	}
+
+	result.profile = HarmonicsTools::getProfileColumns(processor);
+	processor.releaseResources();
+
+	result.nsPerSample = 1e9 * elapsed / (double)(processed * channels);
+	result.realtimeFactor = elapsed > 0.0 ? (double)processed / sampleRate / elapsed : 0.0;
+	return result;
+}
+
+//==============================================================================
+// Golden cases: every mask and the Chebyshev engine, 1x and 2x, stereo 48 kHz, with a parameter change halfway so ramps and crossfades are covered
+struct GoldenResult
+{
+	juce::String name;
+	juce::uint64 hash = 0;
+	juce::Array<double> segmentRMS;
+};
+
+static const int goldenSampleRate = 48000;
+static const int goldenBlockSize = 512;
+static const int goldenSegments = 16;
+static const double goldenTolerance = 1e-4;
+
+// FNV-1a over the raw sample bits
+static juce::uint64 hashAudio(const juce::AudioBuffer<float>& audio)
+{
+	juce::uint64 hash = 14695981039346656037ull;
+
+	for (int channel = 0; channel < audio.getNumChannels(); ++channel)
+	{
+		const float* data = audio.getReadPointer(channel);
+
+		for (int sample = 0; sample < audio.getNumSamples(); ++sample)
+		{
+			juce::uint32 bits;
+			std::memcpy(&bits, data + sample, sizeof(bits));
+
+			hash = (hash ^ bits) * 1099511628211ull;
+		}
+	}
+
+	return hash;
+}
+
+static juce::Array<GoldenResult> renderGolden()
+{
+	juce::Array<GoldenResult> results;
+
+	for (int oversampling = 0; oversampling <= 1; ++oversampling)
+	{
+		for (int mask = 0; mask <= chebyshevMask; ++mask)
+		{
+			HarmonicsAudioProcessor processor;
+			applyMask(processor, mask);
+			HarmonicsTools::applyParameter(processor, "Gain", "6");
+			HarmonicsTools::applyParameter(processor, "Mix", "0.8");
+			HarmonicsTools::applyParameter(processor, "Oversampling", juce::String(oversampling));
+
+			processor.setNonRealtime(true);
+			processor.setPlayConfigDetails(2, 2, goldenSampleRate, goldenBlockSize);
+			processor.prepareToPlay(goldenSampleRate, goldenBlockSize);
+
+			juce::AudioBuffer<float> audio(2, goldenSampleRate);
+			fillTestSignal(audio, goldenSampleRate);
+
+			juce::MidiBuffer midi;
+			const int changePosition = (audio.getNumSamples() / 2 / goldenBlockSize) * goldenBlockSize;
+
+			for (int position = 0; position < audio.getNumSamples(); position += goldenBlockSize)
+			{
+				if (position == changePosition)
+				{
+					// Chebyshev case ramps its levels instead
+					applyMask(processor, mask == chebyshevMask ? mask : mask ^ 0x5, 0.03f);
+					HarmonicsTools::applyParameter(processor, "Gain", "-3");
+					HarmonicsTools::applyParameter(processor, "Volume", "-6");
+				}
+
+				const int samples = juce::jmin(goldenBlockSize, audio.getNumSamples() - position);
+				juce::AudioBuffer<float> block(audio.getArrayOfWritePointers(), 2, position, samples);
+				processor.processBlock(block, midi);
+			}
+
+			GoldenResult result;
+			result.name = "mask" + juce::String(mask) + "_os" + juce::String(oversampling);
+
+			result.hash = hashAudio(audio);
+
+			const int segmentSize = audio.getNumSamples() / goldenSegments;
+
+			for (int segment = 0; segment < goldenSegments; ++segment)
+			{
+				const double rms = 0.5 * (audio.getRMSLevel(0, segment * segmentSize, segmentSize) + audio.getRMSLevel(1, segment * segmentSize, segmentSize));
+				result.segmentRMS.add(rms);
+			}
+
+			results.add(result);
+		}
+	}
+
+	return results;
+}
+
+static juce::String goldenToLine(const GoldenResult& result)
+{
+	juce::String line = result.name + " " + juce::String::toHexString((juce::int64)result.hash);
+
+	for (auto rms : result.segmentRMS)
+	{
+		line += " " + juce::String(rms, 9);
+	}
+
+	return line;
+}
+
+// Bit-exact match passes, otherwise every segment RMS has to be within the tolerance
+static bool checkGolden(const juce::File& file)
+{
+	juce::StringArray lines;
+	lines.addLines(file.loadFileAsString());
+
+	std::map<juce::String, juce::StringArray> expected;
+
+	for (const auto& line : lines)
+	{
+		auto tokens = juce::StringArray::fromTokens(line, " ", "");
+
+		if (tokens.size() == 2 + goldenSegments)
+		{
+			expected[tokens[0]] = tokens;
+		}
+	}
+
+	int failed = 0;
+	int exact = 0;
+	const auto results = renderGolden();
+
+	for (const auto& result : results)
+	{
+		auto found = expected.find(result.name);
+
+		if (found == expected.end())
+		{
+			std::cout << result.name << " MISSING" << std::endl;
+			++failed;
+			continue;
+		}
+
+		const auto& tokens = found->second;
+
+		if (tokens[1] == juce::String::toHexString((juce::int64)result.hash))
+		{
+			++exact;
+			continue;
+		}
+
+		double maxError = 0.0;
+
+		for (int segment = 0; segment < goldenSegments; ++segment)
+		{
+			const double reference = tokens[2 + segment].getDoubleValue();
+			maxError = juce::jmax(maxError, std::abs(result.segmentRMS[segment] - reference) / juce::jmax(reference, 1e-6));
+		}
+
+		const bool passed = maxError <= goldenTolerance;
+		std::cout << result.name << (passed ? " OK" : " FAIL") << " (not bit-exact, max RMS error " << juce::String(maxError, 7) << ")" << std::endl;
+
+		if (! passed)
+		{
+			++failed;
+		}
+	}
+
+	std::cout << "Golden: " << exact << " bit-exact, " << (results.size() - exact - failed) << " within tolerance, " << failed << " failed" << std::endl;
+	return failed == 0;
+}
+
+//==============================================================================
+// Worker pool path against the serial one, 16 channels in blocks large enough to go parallel
+static const int parallelChannels = 16;
+static const int parallelBlockSize = 8192;
+
+static juce::uint64 renderParallelCase(int mask, int oversampling, bool parallel)
+{
+	HarmonicsAudioProcessor processor;
+	applyMask(processor, mask);
+	HarmonicsTools::applyParameter(processor, "Gain", "6");
+	HarmonicsTools::applyParameter(processor, "Oversampling", juce::String(oversampling));
+	processor.setParallelProcessing(parallel);
+
+	processor.setNonRealtime(true);
+	processor.setPlayConfigDetails(parallelChannels, parallelChannels, goldenSampleRate, parallelBlockSize);
+	processor.prepareToPlay(goldenSampleRate, parallelBlockSize);
+
+	juce::AudioBuffer<float> audio(parallelChannels, 4 * parallelBlockSize);
+	fillTestSignal(audio, goldenSampleRate);
+
+	juce::MidiBuffer midi;
+
+	for (int position = 0; position < audio.getNumSamples(); position += parallelBlockSize)
+	{
+		juce::AudioBuffer<float> block(audio.getArrayOfWritePointers(), parallelChannels, position, parallelBlockSize);
+		processor.processBlock(block, midi);
+	}
+
+	return hashAudio(audio);
+}
+
+static bool checkParallel()
+{
+	int failed = 0;
+
+	for (int oversampling = 0; oversampling <= 1; ++oversampling)
+	{
+		for (int mask = 0; mask <= chebyshevMask; ++mask)
+		{
+			if (renderParallelCase(mask, oversampling, false) != renderParallelCase(mask, oversampling, true))
+			{
+				std::cout << "mask" << mask << "_os" << oversampling << " FAIL (parallel output differs)" << std::endl;
+				++failed;
+			}
+		}
+	}
+
+	std::cout << "Parallel: " << (2 * (chebyshevMask + 1) - failed) << " bit-identical, " << failed << " failed" << std::endl;
+	return failed == 0;
+}
+
+//==============================================================================
+// Binary state round trip per preset, XML blobs of older versions must load to the same values
+static const int stateIterations = 1000;
+
+static bool checkState()
+{
+	HarmonicsAudioProcessor source;
+	HarmonicsAudioProcessor target;
+	int failed = 0;
+
+	for (int program = 0; program < source.getNumPrograms(); ++program)
+	{
+		source.setCurrentProgram(program);
+
+		juce::MemoryBlock binary, roundTrip, fromXml, xml;
+		source.getStateInformation(binary);
+
+		target.setCurrentProgram((program + 1) % source.getNumPrograms());
+		target.setStateInformation(binary.getData(), (int)binary.getSize());
+		target.getStateInformation(roundTrip);
+
+		// XML blob the way older versions saved it
+		std::unique_ptr<juce::XmlElement> state(source.apvts.copyState().createXml());
+		juce::AudioProcessor::copyXmlToBinary(*state, xml);
+
+		target.setCurrentProgram((program + 1) % source.getNumPrograms());
+		target.setStateInformation(xml.getData(), (int)xml.getSize());
+		target.getStateInformation(fromXml);
+
+		// The XML blob has no program, only the parameters after the header have to match
+		const bool binaryOk = binary == roundTrip;
+		const bool xmlOk = binary.getSize() == fromXml.getSize()
+			&& std::memcmp(binary.begin() + HarmonicsAudioProcessor::STATE_HEADER_SIZE, fromXml.begin() + HarmonicsAudioProcessor::STATE_HEADER_SIZE, binary.getSize() - HarmonicsAudioProcessor::STATE_HEADER_SIZE) == 0;
+
+		std::cout << source.getProgramName(program) << ": " << (int)binary.getSize() << " bytes binary, " << (int)xml.getSize() << " bytes XML"
+				  << (binaryOk ? "" : ", binary FAIL") << (xmlOk ? "" : ", XML FAIL") << std::endl;
+
+		failed += (binaryOk ? 0 : 1) + (xmlOk ? 0 : 1);
+	}
+
+	// Save and load times, binary against the old XML path
+	juce::MemoryBlock binary, xml;
+	source.getStateInformation(binary);
+
+	double start = getSeconds();
+
+	for (int i = 0; i < stateIterations; ++i)
+	{
+		source.getStateInformation(binary);
+		target.setStateInformation(binary.getData(), (int)binary.getSize());
+	}
+
+	const double binaryTime = (getSeconds() - start) / stateIterations;
+	start = getSeconds();
+
+	for (int i = 0; i < stateIterations; ++i)
+	{
+		std::unique_ptr<juce::XmlElement> state(source.apvts.copyState().createXml());
+		juce::AudioProcessor::copyXmlToBinary(*state, xml);
+		target.setStateInformation(xml.getData(), (int)xml.getSize());
+	}
+
+	const double xmlTime = (getSeconds() - start) / stateIterations;
+	start = getSeconds();
+
+	for (int i = 0; i < stateIterations; ++i)
+	{
+		target.setCurrentProgram(i % target.getNumPrograms());
+	}
+
+	const double presetTime = (getSeconds() - start) / stateIterations;
+
+	std::cout << "Save + load: binary " << binaryTime * 1.0e6 << " us, XML " << xmlTime * 1.0e6 << " us, preset switch " << presetTime * 1.0e6 << " us" << std::endl;
+	std::cout << "State: " << failed << " failed" << std::endl;
+	return failed == 0;
+}
+
+//==============================================================================
+static juce::Array<int> parseList(const juce::String& text)
+{
+	juce::Array<int> values;
+
+	for (const auto& token : juce::StringArray::fromTokens(text, ",", ""))
+	{
+		if (token.trim().isNotEmpty())
+		{
+			values.add(token.trim().getIntValue());
+		}
+	}
+
+	return values;
+}
+
+static std::map<juce::String, double> loadBaseline(const juce::File& file)
+{
+	std::map<juce::String, double> baseline;
+
+	juce::StringArray lines;
+	lines.addLines(file.loadFileAsString());
+
+	for (const auto& line : lines)
+	{
+		auto tokens = juce::StringArray::fromTokens(line, ",", "");
+
+		if (tokens.size() == 9 && tokens[0] != "kind")
+		{
+			const double nsPerSample = tokens[7].getDoubleValue();
+
+			tokens.removeRange(7, 2);
+			baseline[tokens.joinIntoString(",")] = nsPerSample;
+		}
+	}
+
+	return baseline;
+}
+
+static void printUsage()
+{
+	std::cout << "Usage: HarmonicsBenchmark [options]" << std::endl
+			  << "  --blocks <list>          Block sizes, default 16,32,64,128,256,512,1024,2048,4096" << std::endl
+			  << "  --rates <list>           Sample rates, default 44100,48000,88200,96000,176400,192000" << std::endl
+			  << "  --channels <list>        Channel counts, default 1,2,6,16" << std::endl
+			  << "  --masks <list>           Button masks 0-15, 16 = Chebyshev engine, default all" << std::endl
+			  << "  --oversampling <list>    Oversampling choices 0-3, default 0" << std::endl
+			  << "  --precision <list>       32 and/or 64 bit processing, default 32,64" << std::endl
+			  << "  --seconds <value>        Audio seconds per case, default 1" << std::endl
+			  << "  --csv <file>             Write results as CSV" << std::endl
+			  << "  --compare <file>         Speedup against an earlier CSV" << std::endl
+			  << "  --profile <file>         Write the processor's processBlock timing as CSV" << std::endl
+			  << "  --write-golden <file>    Write golden output checksums" << std::endl
+			  << "  --check-golden <file>    Compare against golden output checksums" << std::endl
+			  << "  --check-parallel         Compare worker pool and serial output" << std::endl
+			  << "  --check-state            Round-trip the presets through binary and XML state" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+	BenchmarkSettings settings;
+	juce::File csvFile, compareFile, profileFile;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const juce::String arg(argv[i]);
+
+		if (arg == "--help" || arg == "-h")
+		{
+			printUsage();
+			return 0;
+		}
+
+		if (arg == "--check-parallel")
+		{
+			return checkParallel() ? 0 : 1;
+		}
+
+		if (arg == "--check-state")
+		{
+			return checkState() ? 0 : 1;
+		}
+
+		if (i + 1 >= argc)
+		{
+			std::cout << "Missing value for " << arg << std::endl;
+			return 1;
+		}
+
+		const juce::String value(argv[++i]);
+		const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+
+		if (arg == "--blocks")				settings.blockSizes = parseList(value);
+		else if (arg == "--rates")			settings.sampleRates = parseList(value);
+		else if (arg == "--channels")		settings.channels = parseList(value);
+		else if (arg == "--masks")			settings.masks = parseList(value);
+		else if (arg == "--oversampling")	settings.oversampling = parseList(value);
+		else if (arg == "--precision")		settings.precisions = parseList(value);
+		else if (arg == "--seconds")		settings.seconds = juce::jmax(0.01, value.getDoubleValue());
+		else if (arg == "--csv")			csvFile = file;
+		else if (arg == "--compare")		compareFile = file;
+		else if (arg == "--profile")		profileFile = file;
+		else if (arg == "--write-golden")
+		{
+			juce::StringArray lines;
+
+			for (const auto& result : renderGolden())
+			{
+				lines.add(goldenToLine(result));
+			}
+
+			file.replaceWithText(lines.joinIntoString("\n") + "\n");
+			std::cout << "Wrote " << lines.size() << " golden cases to " << file.getFullPathName() << std::endl;
+			return 0;
+		}
+		else if (arg == "--check-golden")
+		{
+			return checkGolden(file) ? 0 : 1;
+		}
+		else
+		{
+			std::cout << "Unknown option " << arg << std::endl;
+			printUsage();
+			return 1;
+		}
+	}
+
+	// Sweep
+	juce::Array<BenchmarkResult> results;
+
+	for (int sampleRate : settings.sampleRates)
+	{
+		for (int blockSize : settings.blockSizes)
+		{
+			for (int precision : settings.precisions)
+			{
+				const bool isDouble = precision == 64;
+
+				results.add(isDouble ? benchmarkHighPass<double>(sampleRate, blockSize, settings.seconds)
+									 : benchmarkHighPass<float>(sampleRate, blockSize, settings.seconds));
+
+				results.add(isDouble ? benchmarkCascade<double, DirectForm1HighPassSIMD>("df1-chain", sampleRate, blockSize, settings.seconds)
+									 : benchmarkCascade<float, DirectForm1HighPassSIMD>("df1-chain", sampleRate, blockSize, settings.seconds));
+				results.add(isDouble ? benchmarkCascade<double, TransposedDirectForm2HighPassSIMD>("tdf2-chain", sampleRate, blockSize, settings.seconds)
+									 : benchmarkCascade<float, TransposedDirectForm2HighPassSIMD>("tdf2-chain", sampleRate, blockSize, settings.seconds));
+				results.add(isDouble ? benchmarkCascade<double, StateVariableHighPassSIMD>("svf-chain", sampleRate, blockSize, settings.seconds)
+									 : benchmarkCascade<float, StateVariableHighPassSIMD>("svf-chain", sampleRate, blockSize, settings.seconds));
+
+				for (int channels : settings.channels)
+				{
+					for (int oversampling : settings.oversampling)
+					{
+						for (int mask : settings.masks)
+						{
+							results.add(isDouble ? benchmarkProcessor<double>(channels, sampleRate, blockSize, mask, oversampling, settings.seconds)
+												 : benchmarkProcessor<float>(channels, sampleRate, blockSize, mask, oversampling, settings.seconds));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Report
+	const auto baseline = compareFile == juce::File() ? std::map<juce::String, double>() : loadBaseline(compareFile);
+	juce::StringArray csv;
+	csv.add(csvHeader);
+
+	juce::StringArray profile;
+	profile.add("kind,precision,channels,sampleRate,blockSize,mask,oversampling," + HarmonicsTools::getProfileHeader());
+
+	for (const auto& result : results)
+	{
+		csv.add(result.getKey() + "," + juce::String(result.nsPerSample, 3) + "," + juce::String(result.realtimeFactor, 1));
+
+		if (result.profile.isNotEmpty())
+		{
+			profile.add(result.getKey() + "," + result.profile);
+		}
+
+		juce::String line = result.kind.paddedRight(' ', 10)
+			+ juce::String(result.precision) + "bit "
+			+ juce::String(result.channels) + "ch "
+			+ juce::String(result.sampleRate).paddedLeft(' ', 6) + " Hz "
+			+ juce::String(result.blockSize).paddedLeft(' ', 4) + " block "
+			+ "mask " + juce::String(result.mask).paddedLeft(' ', 2) + " "
+			+ HarmonicsAudioProcessor::oversamplingNames[result.oversampling] + " "
+			+ juce::String(result.nsPerSample, 2).paddedLeft(' ', 8) + " ns/sample "
+			+ juce::String(result.realtimeFactor, 1).paddedLeft(' ', 8) + "x realtime";
+
+		auto found = baseline.find(result.getKey());
+
+		if (found != baseline.end() && result.nsPerSample > 0.0)
+		{
+			line += "  " + juce::String(found->second / result.nsPerSample, 2) + "x vs baseline";
+		}
+
+		std::cout << line << std::endl;
+	}
+
+	if (csvFile != juce::File())
+	{
+		csvFile.replaceWithText(csv.joinIntoString("\n") + "\n");
+		std::cout << "Wrote " << results.size() << " results to " << csvFile.getFullPathName() << std::endl;
+	}
+
+	if (profileFile != juce::File())
+	{
+		profileFile.replaceWithText(profile.joinIntoString("\n") + "\n");
+		std::cout << "Wrote " << (profile.size() - 1) << " profiles to " << profileFile.getFullPathName() << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,622 @@
+/*
+  ==============================================================================
+
+    HarmonicsCoreBenchmark
+    Times HarmonicsCore without JUCE, in float and double over block sizes,
+    channel counts, oversampling and all 16 button combinations plus the
+    Chebyshev engine. Every mask runs twice: "core" picks the kernel variant
+    from the settings like the plugin, "fixed" has the set compiled in as
+    the Stages argument. Both have to produce the same output, a mismatch
+    is printed and makes the exit code 1.
+
+    --check-blocks renders automation, a settings change every few
+    milliseconds at sample positions, with every block size and compares
+    the renders. They have to be bit-identical, a difference means the
+    output depends on the host buffer size and makes the exit code 1.
+
+    --check-math measures the error of every FastMath function over its
+    documented range and times it against ExactMath, scalar and on all SIMD
+    lanes. An error above the bound in FastMath.h makes the exit code 1.
+
+    Usage:
+      HarmonicsCoreBenchmark [options]
+
+      --blocks <list>           Block sizes, default 64,512,4096
+      --rate <value>            Sample rate, default 48000
+      --channels <list>         Channel counts, default 1,2,6
+      --masks <list>            Button masks 0-15, bit 0 = Button2 ... bit 3 = Button8,
+                                16 = Chebyshev engine with all harmonics, default all
+      --oversampling <list>     Oversampling factors log2 0-3, default 0
+      --precision <list>        32 and/or 64 bit processing, default 32,64
+      --seconds <value>         Audio seconds per case, default 1
+      --csv <file>              Writes the results as CSV
+      --envelope                Every case with the envelope driven drive on
+      --check-blocks            Only compares automation renders over the block sizes
+      --check-math              Only checks and times the FastMath approximations
+
+    Lists are comma separated.
+
+  ==============================================================================
+*/
+
+#include "../../../Source/HarmonicsCore.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+//==============================================================================
+struct BenchmarkSettings
+{
+	std::vector<int> blockSizes { 64, 512, 4096 };
+	int sampleRate = 48000;
+	std::vector<int> channels { 1, 2, 6 };
+	std::vector<int> masks { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+	std::vector<int> oversampling { 0 };
+	std::vector<int> precisions { 32, 64 };
+	double seconds = 1.0;
+	bool envelope = false;
+	bool checkBlocks = false;
+	bool checkMath = false;
+};
+
+struct BenchmarkResult
+{
+	const char* kind = "";
+	int precision = 32;
+	int channels = 0;
+	int blockSize = 0;
+	int mask = 0;
+	int oversampling = 0;
+
+	double nsPerSample = 0.0;		// Per channel sample at the base rate
+	double realtimeFactor = 0.0;
+	unsigned long long hash = 0;
+};
+
+//==============================================================================
+static double getSeconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Seeded noise over two sines, the same for every case
+template <typename SampleType>
+static std::vector<SampleType> makeTestSignal(int channels, int samples, int sampleRate)
+{
+	std::vector<SampleType> signal((size_t)channels * samples);
+	unsigned int seed = 0x4861726d;
+
+	for (int channel = 0; channel < channels; ++channel)
+	{
+		const double frequency = 110.0 * (channel + 1);
+
+		for (int sample = 0; sample < samples; ++sample)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			const double noise = (double)(seed >> 8) / (double)(1 << 24) - 0.5;
+
+			signal[(size_t)channel * samples + sample] = (SampleType)(0.5 * std::sin(2.0 * 3.14159265358979323846 * frequency * sample / sampleRate) + 0.1 * noise);
+		}
+	}
+
+	return signal;
+}
+
+static HarmonicsSettings getMaskSettings(int mask, int oversampling, bool envelope)
+{
+	HarmonicsSettings settings;
+	settings.oversampling = oversampling;
+	settings.envelope = envelope;
+
+	// Every harmonic up to the 16th, the worst case polynomial degree
+	settings.chebyshev = mask == HarmonicsMask::chebyshev;
+
+	for (int harmonic = 2; harmonic <= ChebyshevLevels::maxHarmonic; ++harmonic)
+	{
+		settings.levels.level[harmonic] = settings.chebyshev ? 0.05f : 0.0f;
+	}
+
+	settings.button2 = settings.sideButton2 = (mask & HarmonicsMask::h2) != 0;
+	settings.button4 = settings.sideButton4 = (mask & HarmonicsMask::h4) != 0;
+	settings.button6 = settings.sideButton6 = (mask & HarmonicsMask::h6) != 0;
+	settings.button8 = settings.sideButton8 = (mask & HarmonicsMask::h8) != 0;
+
+	return settings;
+}
+
+//==============================================================================
+template <typename SampleType, int Stages>
+static BenchmarkResult benchmarkCore(const BenchmarkSettings& settings, int channels, int blockSize, int mask, int oversampling)
+{
+	BenchmarkResult result;
+	result.kind = Stages == HarmonicsMask::runtime ? "core" : "fixed";
+	result.precision = 8 * (int)sizeof(SampleType);
+	result.channels = channels;
+	result.blockSize = blockSize;
+	result.mask = mask;
+	result.oversampling = oversampling;
+
+	const int sampleRate = settings.sampleRate;
+	const auto source = makeTestSignal<SampleType>(channels, sampleRate, sampleRate);
+
+	// Silent until the silence path has settled the kernels, a fixed set then starts from the same state as the runtime one
+	HarmonicsCore<SampleType, Stages> core;
+	core.setSettings(getMaskSettings(mask, oversampling, settings.envelope));
+	core.prepare(sampleRate, channels, blockSize);
+
+	std::vector<SampleType> buffer((size_t)channels * blockSize, SampleType(0));
+	std::vector<SampleType*> pointers((size_t)channels);
+
+	for (int channel = 0; channel < channels; ++channel)
+	{
+		pointers[channel] = buffer.data() + (size_t)channel * blockSize;
+	}
+
+	for (int block = 0; block < 2 + 2 * core.getLatency() / blockSize; ++block)
+	{
+		core.process(pointers.data(), channels, blockSize);
+	}
+
+	const long long totalSamples = std::max((long long)blockSize, (long long)(settings.seconds * sampleRate));
+	unsigned long long hash = 14695981039346656037ull;
+	double elapsed = 0.0;
+	long long processed = 0;
+
+	for (long long position = 0; position < totalSamples; position += blockSize)
+	{
+		const int offset = (int)(position % (sampleRate - blockSize));
+
+		for (int channel = 0; channel < channels; ++channel)
+		{
+			std::memcpy(pointers[channel], source.data() + (size_t)channel * sampleRate + offset, sizeof(SampleType) * blockSize);
+		}
+
+		const double start = getSeconds();
+		core.process(pointers.data(), channels, blockSize);
+		elapsed += getSeconds() - start;
+		processed += blockSize;
+
+		// FNV-1a over the first sample of every channel, enough to catch a different variant
+		for (int channel = 0; channel < channels; ++channel)
+		{
+			unsigned long long bits = 0;
+			std::memcpy(&bits, pointers[channel], sizeof(SampleType));
+
+			hash = (hash ^ bits) * 1099511628211ull;
+		}
+	}
+
+	result.hash = hash;
+	result.nsPerSample = 1e9 * elapsed / (double)(processed * channels);
+	result.realtimeFactor = elapsed > 0.0 ? (double)processed / sampleRate / elapsed : 0.0;
+	return result;
+}
+
+// Fixed stage sets are template arguments, one instantiation per mask
+template <typename SampleType, size_t... Masks>
+static BenchmarkResult benchmarkFixed(const BenchmarkSettings& settings, int channels, int blockSize, int mask, int oversampling, std::index_sequence<Masks...>)
+{
+	using Benchmark = BenchmarkResult (*)(const BenchmarkSettings&, int, int, int, int);
+	static const Benchmark benchmarks[] = { &benchmarkCore<SampleType, (int)Masks>... };
+
+	return benchmarks[mask](settings, channels, blockSize, mask, oversampling);
+}
+
+//==============================================================================
+// Gain, mix, volume, DC blocker and side settings jump every 5 ms, Button4 and the engine
+// toggle now and then. Sorted by sample
+static std::vector<HarmonicsSettingsChange> makeAutomation(int mask, int oversampling, bool envelope, int samples, int sampleRate)
+{
+	std::vector<HarmonicsSettingsChange> changes;
+	const int interval = sampleRate / 200;
+
+	for (int sample = interval, step = 0; sample < samples; sample += interval, ++step)
+	{
+		HarmonicsSettingsChange change;
+		change.sample = sample;
+		change.settings = getMaskSettings(mask, oversampling, envelope);
+		change.settings.midSide = true;
+
+		change.settings.gain = (float)(step % 5) * 3.0f - 6.0f;
+		change.settings.mix = (float)(step % 4) / 3.0f;
+		change.settings.volume = (float)(step % 3) * -2.0f;
+		change.settings.cutoff = step % 2 == 0 ? 20.0f : 120.0f;
+		change.settings.sideGain = (float)(step % 7) - 3.0f;
+		change.settings.sideMix = 1.0f - (float)(step % 3) * 0.25f;
+
+		if ((step / 6) % 2 == 1)
+		{
+			change.settings.button4 = ! change.settings.button4;
+			change.settings.sideButton2 = ! change.settings.sideButton2;
+		}
+
+		if (mask == HarmonicsMask::chebyshev && (step / 10) % 2 == 1)
+		{
+			change.settings.chebyshev = false;
+		}
+
+		changes.push_back(change);
+	}
+
+	return changes;
+}
+
+template <typename SampleType>
+static std::vector<SampleType> renderAutomation(int channels, int blockSize, int mask, int oversampling, bool envelope, int sampleRate)
+{
+	auto output = makeTestSignal<SampleType>(channels, sampleRate, sampleRate);
+	const auto changes = makeAutomation(mask, oversampling, envelope, sampleRate, sampleRate);
+
+	HarmonicsCore<SampleType> core;
+	core.setSettings(getMaskSettings(mask, oversampling, envelope));
+	core.prepare(sampleRate, channels, blockSize);
+
+	std::vector<SampleType*> pointers((size_t)channels);
+	std::vector<HarmonicsSettingsChange> blockChanges;
+	size_t next = 0;
+
+	for (int position = 0; position < sampleRate; position += blockSize)
+	{
+		const int samples = std::min(blockSize, sampleRate - position);
+
+		for (int channel = 0; channel < channels; ++channel)
+		{
+			pointers[channel] = output.data() + (size_t)channel * sampleRate + position;
+		}
+
+		// Changes of this block, relative to its start
+		blockChanges.clear();
+
+		for (; next < changes.size() && changes[next].sample < position + samples; ++next)
+		{
+			blockChanges.push_back(changes[next]);
+			blockChanges.back().sample -= position;
+		}
+
+		core.process(pointers.data(), channels, samples, blockChanges.data(), (int)blockChanges.size());
+	}
+
+	return output;
+}
+
+// Every block size against the render with the first one
+template <typename SampleType>
+static bool checkBlocks(const BenchmarkSettings& settings, int channels, int mask, int oversampling)
+{
+	const auto reference = renderAutomation<SampleType>(channels, settings.blockSizes.front(), mask, oversampling, settings.envelope, settings.sampleRate);
+	bool passed = true;
+
+	for (int blockSize : settings.blockSizes)
+	{
+		const auto render = renderAutomation<SampleType>(channels, blockSize, mask, oversampling, settings.envelope, settings.sampleRate);
+		double difference = 0.0;
+
+		for (size_t index = 0; index < render.size(); ++index)
+		{
+			difference = std::max(difference, std::abs((double)render[index] - (double)reference[index]));
+		}
+
+		const bool ok = difference == 0.0;
+		passed = passed && ok;
+
+		std::printf("%dbit %2dch block %4d mask %2d %dx max difference %.3g %s\n", 8 * (int)sizeof(SampleType), channels, blockSize, mask,
+					1 << oversampling, difference, ok ? "ok" : "FAIL (depends on the block size)");
+	}
+
+	return passed;
+}
+
+//==============================================================================
+// FastMath against a double reference over the documented range, with both tiers
+// timed per value. The vector run has to give the same values as the single lane one, which
+// the scalar overloads may skip for libm
+static float broadcastLike(float, float value) { return value; }
+
+template <typename Vec>
+static Vec broadcastLike(Vec, float value) { return Vec::broadcast(value); }
+
+template <typename Fast, typename Exact, typename Reference, typename Error>
+static bool checkMath(const char* name, const std::vector<float>& inputs, float maxError, Fast fast, Exact exact, Reference reference, Error error)
+{
+	using Vec = SIMDVectorFor<float>::Type;
+
+	const size_t count = inputs.size() - inputs.size() % Vec::size;
+	std::vector<float> scalar(count), vector(count), exactValues(count);
+
+	// Best of a few passes, each over every input
+	auto time = [count](auto&& pass)
+	{
+		double best = 1.0e9;
+
+		for (int run = 0; run < 5; ++run)
+		{
+			const double start = getSeconds();
+			pass();
+			best = std::min(best, getSeconds() - start);
+		}
+
+		return best * 1.0e9 / (double)count;
+	};
+
+	const double exactNs = time([&] { for (size_t index = 0; index < count; ++index) exactValues[index] = exact(inputs[index]); });
+	const double scalarNs = time([&] { for (size_t index = 0; index < count; ++index) scalar[index] = fast(inputs[index]); });
+	const double vectorNs = time([&] { for (size_t index = 0; index < count; index += Vec::size) fast(Vec::load(&inputs[index])).store(&vector[index]); });
+
+	double largest = 0.0;
+	bool lanesMatch = true;
+
+	for (size_t index = 0; index < count; ++index)
+	{
+		const double expected = reference((double)inputs[index]);
+		const float lane = fast(FloatVec1 { inputs[index] }).v;
+
+		largest = std::max(largest, error((double)scalar[index], expected, (double)inputs[index]));
+		largest = std::max(largest, error((double)vector[index], expected, (double)inputs[index]));
+		lanesMatch = lanesMatch && std::memcmp(&lane, &vector[index], sizeof(float)) == 0;
+	}
+
+	const bool passed = largest <= maxError && lanesMatch;
+
+	std::printf("%-15s max error %.3g (bound %.3g)  exact %6.2f ns  fast %6.2f ns  %dx %6.2f ns  speedup %5.1fx %5.1fx %s\n", name, largest, (double)maxError,
+				exactNs, scalarNs, Vec::size, vectorNs, exactNs / scalarNs, exactNs / vectorNs,
+				! lanesMatch ? "FAIL (lanes differ)" : largest > maxError ? "FAIL (above the bound)" : "ok");
+
+	return passed;
+}
+
+static std::vector<float> makeRange(double low, double high, bool logarithmic)
+{
+	std::vector<float> values((size_t)1 << 20);
+
+	for (size_t index = 0; index < values.size(); ++index)
+	{
+		const double position = (double)index / (double)(values.size() - 1);
+		values[index] = (float)(logarithmic ? low * std::pow(high / low, position) : low + (high - low) * position);
+	}
+
+	return values;
+}
+
+static int checkMathTiers()
+{
+	auto relative = [](double value, double reference, double) { return std::abs(value - reference) / reference; };
+	auto scaled = [](double value, double reference, double) { return std::abs(value - reference) / std::max(1.0, std::abs(reference)); };
+	auto absolute = [](double value, double reference, double) { return std::abs(value - reference); };
+
+	// Every positive normal float from the smallest up, logarithmic steps cover each binade alike
+	const auto positive = makeRange(1.2e-38, 3.4e38, true);
+	int failures = 0;
+
+	failures += checkMath("exp2", makeRange(-126.0, 127.0, false), FastMath::EXP2_MAX_ERROR,
+						  [](auto x) { return FastMath::exp2(x); }, [](float x) { return ExactMath::exp2(x); },
+						  [](double x) { return std::exp2(x); }, relative) ? 0 : 1;
+	failures += checkMath("log2", positive, FastMath::LOG2_MAX_ERROR,
+						  [](auto x) { return FastMath::log2(x); }, [](float x) { return ExactMath::log2(x); },
+						  [](double x) { return std::log2(x); }, scaled) ? 0 : 1;
+	failures += checkMath("exp", makeRange(-80.0, 80.0, false), FastMath::EXP_MAX_ERROR,
+						  [](auto x) { return FastMath::exp(x); }, [](float x) { return ExactMath::exp(x); },
+						  [](double x) { return std::exp(x); }, relative) ? 0 : 1;
+	failures += checkMath("log", positive, FastMath::LOG_MAX_ERROR,
+						  [](auto x) { return FastMath::log(x); }, [](float x) { return ExactMath::log(x); },
+						  [](double x) { return std::log(x); }, scaled) ? 0 : 1;
+
+	// Exponent 1.9 keeps |exponent * log2 base| below 20 over the range
+	failures += checkMath("pow(x, 1.9)", makeRange(1.0e-3, 1.0e3, true), FastMath::POW_MAX_ERROR,
+						  [](auto x) { return FastMath::pow(x, broadcastLike(x, 1.9f)); }, [](float x) { return ExactMath::pow(x, 1.9f); },
+						  [](double x) { return std::pow(x, (double)1.9f); }, relative) ? 0 : 1;
+
+	// Error of the gain in dB
+	failures += checkMath("decibelsToGain", makeRange(-100.0, 40.0, false), FastMath::DECIBELS_MAX_ERROR,
+						  [](auto x) { return FastMath::decibelsToGain(x); }, [](float x) { return ExactMath::decibelsToGain(x); },
+						  [](double x) { return x; }, [](double value, double reference, double) { return std::abs(20.0 * std::log10(value) - reference); }) ? 0 : 1;
+	failures += checkMath("gainToDecibels", makeRange(1.0e-5, 100.0, true), FastMath::DECIBELS_MAX_ERROR,
+						  [](auto x) { return FastMath::gainToDecibels(x); }, [](float x) { return ExactMath::gainToDecibels(x); },
+						  [](double x) { return 20.0 * std::log10(x); }, absolute) ? 0 : 1;
+
+	std::printf("Math tier (%s in the DSP): %d failures\n", HARMONICS_FAST_MATH ? "fast" : "exact", failures);
+	return failures;
+}
+
+//==============================================================================
+static std::vector<int> parseList(const std::string& text)
+{
+	std::vector<int> values;
+	size_t start = 0;
+
+	while (start < text.size())
+	{
+		const size_t end = std::min(text.find(',', start), text.size());
+
+		if (end > start)
+		{
+			values.push_back(std::atoi(text.substr(start, end - start).c_str()));
+		}
+
+		start = end + 1;
+	}
+
+	return values;
+}
+
+static void printUsage()
+{
+	std::printf("Usage: HarmonicsCoreBenchmark [options]\n"
+				"  --blocks <list>          Block sizes, default 64,512,4096\n"
+				"  --rate <value>           Sample rate, default 48000\n"
+				"  --channels <list>        Channel counts, default 1,2,6\n"
+				"  --masks <list>           Button masks 0-15, 16 = Chebyshev engine, default all\n"
+				"  --oversampling <list>    Oversampling factors log2 0-3, default 0\n"
+				"  --precision <list>       32 and/or 64 bit processing, default 32,64\n"
+				"  --seconds <value>        Audio seconds per case, default 1\n"
+				"  --csv <file>             Write results as CSV\n"
+				"  --envelope               Run every case with the envelope drive on\n"
+				"  --check-blocks           Compare automation renders over the block sizes\n"
+				"  --check-math             Check and time the FastMath approximations\n");
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkSettings settings;
+	std::string csvFile;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg(argv[i]);
+
+		if (arg == "--help" || arg == "-h")
+		{
+			printUsage();
+			return 0;
+		}
+
+		if (arg == "--envelope")
+		{
+			settings.envelope = true;
+			continue;
+		}
+
+		if (arg == "--check-blocks")
+		{
+			settings.checkBlocks = true;
+			continue;
+		}
+
+		if (arg == "--check-math")
+		{
+			settings.checkMath = true;
+			continue;
+		}
+
+		if (i + 1 >= argc)
+		{
+			std::printf("Missing value for %s\n", arg.c_str());
+			return 1;
+		}
+
+		const std::string value(argv[++i]);
+
+		if (arg == "--blocks")				settings.blockSizes = parseList(value);
+		else if (arg == "--rate")			settings.sampleRate = std::max(8000, std::atoi(value.c_str()));
+		else if (arg == "--channels")		settings.channels = parseList(value);
+		else if (arg == "--masks")			settings.masks = parseList(value);
+		else if (arg == "--oversampling")	settings.oversampling = parseList(value);
+		else if (arg == "--precision")		settings.precisions = parseList(value);
+		else if (arg == "--seconds")		settings.seconds = std::max(0.01, std::atof(value.c_str()));
+		else if (arg == "--csv")			csvFile = value;
+		else
+		{
+			std::printf("Unknown option %s\n", arg.c_str());
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (settings.checkMath)
+	{
+		return checkMathTiers() == 0 ? 0 : 1;
+	}
+
+	if (settings.checkBlocks)
+	{
+		int failures = 0;
+
+		for (int precision : settings.precisions)
+		{
+			for (int channels : settings.channels)
+			{
+				for (int oversampling : settings.oversampling)
+				{
+					for (int mask : settings.masks)
+					{
+						if (settings.blockSizes.empty() || channels < 1 || channels > HarmonicsCore<float>::MAX_CHANNELS || mask < 0 || mask > HarmonicsMask::chebyshev)
+						{
+							continue;
+						}
+
+						const bool passed = precision == 64 ? checkBlocks<double>(settings, channels, mask, oversampling)
+															: checkBlocks<float>(settings, channels, mask, oversampling);
+						failures += passed ? 0 : 1;
+					}
+				}
+			}
+		}
+
+		std::printf("Block sizes: %d failures\n", failures);
+		return failures == 0 ? 0 : 1;
+	}
+
+	// Sweep, each mask with the runtime and the fixed stage set
+	std::vector<BenchmarkResult> results;
+	int mismatches = 0;
+
+	for (int blockSize : settings.blockSizes)
+	{
+		for (int precision : settings.precisions)
+		{
+			for (int channels : settings.channels)
+			{
+				for (int oversampling : settings.oversampling)
+				{
+					for (int mask : settings.masks)
+					{
+						if (blockSize < 1 || blockSize >= settings.sampleRate || channels < 1 || channels > HarmonicsCore<float>::MAX_CHANNELS
+							|| mask < 0 || mask > HarmonicsMask::chebyshev)
+						{
+							continue;
+						}
+
+						const auto masks = std::make_index_sequence<HarmonicsMask::chebyshev + 1>();
+						const bool isDouble = precision == 64;
+
+						const auto core = isDouble ? benchmarkCore<double, HarmonicsMask::runtime>(settings, channels, blockSize, mask, oversampling)
+												   : benchmarkCore<float, HarmonicsMask::runtime>(settings, channels, blockSize, mask, oversampling);
+						const auto fixed = isDouble ? benchmarkFixed<double>(settings, channels, blockSize, mask, oversampling, masks)
+													: benchmarkFixed<float>(settings, channels, blockSize, mask, oversampling, masks);
+
+						results.push_back(core);
+						results.push_back(fixed);
+
+						if (core.hash != fixed.hash)
+						{
+							std::printf("%dbit %dch block %d mask %d os %d FAIL (fixed output differs)\n", precision, channels, blockSize, mask, oversampling);
+							++mismatches;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Report
+	FILE* csv = csvFile.empty() ? nullptr : std::fopen(csvFile.c_str(), "w");
+
+	if (csv != nullptr)
+	{
+		std::fprintf(csv, "kind,precision,channels,sampleRate,blockSize,mask,oversampling,nsPerSample,realtimeFactor\n");
+	}
+
+	for (const auto& result : results)
+	{
+		std::printf("%-6s %dbit %2dch %6d Hz %4d block mask %2d %dx %8.2f ns/sample %8.1fx realtime\n", result.kind, result.precision, result.channels,
+					settings.sampleRate, result.blockSize, result.mask, 1 << result.oversampling, result.nsPerSample, result.realtimeFactor);
+
+		if (csv != nullptr)
+		{
+			std::fprintf(csv, "%s,%d,%d,%d,%d,%d,%d,%.3f,%.1f\n", result.kind, result.precision, result.channels, settings.sampleRate,
+						 result.blockSize, result.mask, result.oversampling, result.nsPerSample, result.realtimeFactor);
+		}
+	}
+
+	if (csv != nullptr)
+	{
+		std::fclose(csv);
+		std::printf("Wrote %d results to %s\n", (int)results.size(), csvFile.c_str());
+	}
+
+	std::printf("Fixed stage sets: %d mismatches\n", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
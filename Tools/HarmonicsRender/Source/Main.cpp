@@ -0,0 +1,298 @@
+/*
+  ==============================================================================
+
+    HarmonicsRender
+    Offline batch renderer, streams audio files through HarmonicsAudioProcessor
+    without a host. Files are rendered in parallel, one processor per file.
+
+    Usage:
+      HarmonicsRender [options] <input files...>
+
+      --<ParameterID> <value>   Gain, Mix, Volume, Cutoff, Q, Button2..8, Oversampling,
+                                Engine, Harmonic2..16, Limiter, Lookahead, Mode, SideGain,
+                                SideMix, SideButton2..8, Envelope, Depth, Attack, Release
+      --preset <file>           "ParameterID=value" lines or a saved XML state,
+                                command line values override the preset
+      --out <directory>         Output directory, default next to the input
+      --suffix <text>           Appended to the output name, default "_harmonics"
+      --threads <n>             Default is the number of CPU cores
+      --block <samples>         Processing block size, default 65536
+      --profile <file>          Writes the processBlock timing of every file as CSV
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Common/HarmonicsToolUtilities.h"
+
+#include <iostream>
+#include <mutex>
+
+//==============================================================================
+struct RenderSettings
+{
+	juce::StringPairArray parameters;
+	juce::File outputDirectory;
+	juce::String suffix = "_harmonics";
+	int threads = juce::SystemStats::getNumCpus();
+	int blockSize = 65536;
+	juce::File profileFile;
+};
+
+static std::mutex s_consoleLock;
+
+// One CSV line per rendered file, only with --profile
+static std::mutex s_profileLock;
+static juce::StringArray s_profileLines;
+
+static void printLine(const juce::String& text)
+{
+	std::lock_guard<std::mutex> lock(s_consoleLock);
+	std::cout << text << std::endl;
+}
+
+//==============================================================================
+static bool renderFile(const juce::File& inputFile, const RenderSettings& settings)
+{
+	juce::AudioFormatManager formatManager;
+	formatManager.registerBasicFormats();
+
+	std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+
+	if (reader == nullptr)
+	{
+		printLine("Cannot read " + inputFile.getFullPathName());
+		return false;
+	}
+
+	const int channels = (int)reader->numChannels;
+	const double sampleRate = reader->sampleRate;
+	const juce::int64 length = reader->lengthInSamples;
+
+	// Processor
+	HarmonicsAudioProcessor processor;
+
+	HarmonicsTools::applyParameters(processor, settings.parameters);
+
+	processor.setNonRealtime(true);
+	processor.setPlayConfigDetails(channels, channels, sampleRate, settings.blockSize);
+
+	if (processor.getTotalNumOutputChannels() != channels)
+	{
+		printLine("Unsupported channel count " + juce::String(channels) + " in " + inputFile.getFullPathName());
+		return false;
+	}
+
+	processor.prepareToPlay(sampleRate, settings.blockSize);
+
+	// Writer, same format and bit depth as the input
+	const auto outputDirectory = settings.outputDirectory == juce::File() ? inputFile.getParentDirectory() : settings.outputDirectory;
+	const auto outputFile = outputDirectory.getChildFile(inputFile.getFileNameWithoutExtension() + settings.suffix + inputFile.getFileExtension());
+
+	auto* format = formatManager.findFormatForFileExtension(outputFile.getFileExtension());
+
+	if (format == nullptr)
+	{
+		printLine("No writer for " + outputFile.getFullPathName());
+		return false;
+	}
+
+	outputFile.deleteFile();
+	std::unique_ptr<juce::OutputStream> stream(outputFile.createOutputStream());
+	std::unique_ptr<juce::AudioFormatWriter> writer;
+
+	if (stream != nullptr)
+	{
+		writer.reset(format->createWriterFor(stream.get(), sampleRate, (unsigned int)channels, (int)reader->bitsPerSample, reader->metadataValues, 0));
+	}
+
+	if (writer == nullptr)
+	{
+		printLine("Cannot write " + outputFile.getFullPathName());
+		return false;
+	}
+
+	stream.release();
+
+	// Stream through the processor, the latency is skipped at the start and flushed with silence at the end
+	const int latency = processor.getLatencySamples();
+	const juce::int64 totalSamples = length + latency;
+
+	juce::AudioBuffer<float> buffer(channels, settings.blockSize);
+	juce::MidiBuffer midi;
+
+	const double startTime = juce::Time::getMillisecondCounterHiRes();
+
+	for (juce::int64 position = 0; position < totalSamples; position += settings.blockSize)
+	{
+		const int samples = (int)juce::jmin((juce::int64)settings.blockSize, totalSamples - position);
+
+		buffer.setSize(channels, samples, false, false, true);
+		reader->read(&buffer, 0, samples, position, true, true);
+
+		processor.processBlock(buffer, midi);
+
+		const int first = (int)juce::jlimit((juce::int64)0, (juce::int64)samples, (juce::int64)latency - position);
+
+		if (first < samples)
+		{
+			writer->writeFromAudioSampleBuffer(buffer, first, samples - first);
+		}
+	}
+
+	if (settings.profileFile != juce::File())
+	{
+		const auto columns = HarmonicsTools::getProfileColumns(processor);
+
+		std::lock_guard<std::mutex> lock(s_profileLock);
+		s_profileLines.add(inputFile.getFileName().quoted() + "," + juce::String(settings.blockSize) + "," + (columns.isEmpty() ? "profiling disabled" : columns));
+	}
+
+	processor.releaseResources();
+
+	const double seconds = 0.001 * (juce::Time::getMillisecondCounterHiRes() - startTime);
+	const double realtime = seconds > 0.0 ? (double)length / sampleRate / seconds : 0.0;
+
+	printLine(inputFile.getFileName() + " -> " + outputFile.getFullPathName() + " (" + juce::String(realtime, 1) + "x realtime)");
+	return true;
+}
+
+//==============================================================================
+static void printUsage()
+{
+	std::cout << "Usage: HarmonicsRender [options] <input files...>" << std::endl
+			  << "  --<ParameterID> <value>  Gain, Mix, Volume, Cutoff, Q, Button2, Button4, Button6, Button8," << std::endl
+			  << "                           Oversampling, Engine (Classic, Chebyshev), Harmonic2 ... Harmonic16," << std::endl
+			  << "                           Limiter (on, off), Lookahead (0.5 ms, 1 ms, 2 ms, 5 ms)," << std::endl
+			  << "                           Mode (Stereo, Mid/Side), SideGain, SideMix, SideButton2 ... SideButton8," << std::endl
+			  << "                           Envelope (on, off), Depth, Attack, Release (ms)" << std::endl
+			  << "  --preset <file>          \"ParameterID=value\" lines or a saved XML state" << std::endl
+			  << "  --out <directory>        Output directory, default next to the input" << std::endl
+			  << "  --suffix <text>          Appended to the output name, default _harmonics" << std::endl
+			  << "  --threads <n>            Parallel files, default number of CPU cores" << std::endl
+			  << "  --block <samples>        Processing block size, default 65536" << std::endl
+			  << "  --profile <file>         Write processBlock timing per file as CSV" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+	RenderSettings settings;
+	juce::StringPairArray commandLineParameters;
+	juce::Array<juce::File> inputFiles;
+
+	// Parameter IDs known by the processor
+	const auto parameterIDs = HarmonicsTools::getParameterIDs(HarmonicsAudioProcessor());
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const juce::String arg(argv[i]);
+
+		if (arg == "--help" || arg == "-h")
+		{
+			printUsage();
+			return 0;
+		}
+
+		if (! arg.startsWith("--"))
+		{
+			inputFiles.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+			continue;
+		}
+
+		if (i + 1 >= argc)
+		{
+			std::cout << "Missing value for " << arg << std::endl;
+			return 1;
+		}
+
+		const juce::String option = arg.substring(2);
+		const juce::String value(argv[++i]);
+
+		if (option == "preset")
+		{
+			if (! HarmonicsTools::loadPreset(juce::File::getCurrentWorkingDirectory().getChildFile(value), settings.parameters))
+			{
+				std::cout << "Cannot read preset " << value << std::endl;
+				return 1;
+			}
+		}
+		else if (option == "out")
+		{
+			settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+			settings.outputDirectory.createDirectory();
+		}
+		else if (option == "suffix")
+		{
+			settings.suffix = value;
+		}
+		else if (option == "threads")
+		{
+			settings.threads = juce::jmax(1, value.getIntValue());
+		}
+		else if (option == "block")
+		{
+			settings.blockSize = juce::jmax(16, value.getIntValue());
+		}
+		else if (option == "profile")
+		{
+			settings.profileFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+		}
+		else if (parameterIDs.contains(option, true))
+		{
+			commandLineParameters.set(parameterIDs[parameterIDs.indexOf(option, true)], value);
+		}
+		else
+		{
+			std::cout << "Unknown option " << arg << std::endl;
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (inputFiles.isEmpty())
+	{
+		printUsage();
+		return 1;
+	}
+
+	// Command line overrides the preset
+	settings.parameters.addArray(commandLineParameters);
+
+	std::atomic<int> failed { 0 };
+	const double startTime = juce::Time::getMillisecondCounterHiRes();
+
+	{
+		juce::ThreadPool pool(juce::jmin(settings.threads, inputFiles.size()));
+
+		for (const auto& file : inputFiles)
+		{
+			pool.addJob([file, &settings, &failed]
+			{
+				if (! renderFile(file, settings))
+				{
+					++failed;
+				}
+			});
+		}
+
+		while (pool.getNumJobs() > 0)
+		{
+			juce::Thread::sleep(20);
+		}
+	}
+
+	const double seconds = 0.001 * (juce::Time::getMillisecondCounterHiRes() - startTime);
+
+	if (settings.profileFile != juce::File())
+	{
+		s_profileLines.insert(0, "file,blockSize," + HarmonicsTools::getProfileHeader());
+		settings.profileFile.replaceWithText(s_profileLines.joinIntoString("\n") + "\n");
+		std::cout << "Wrote profile to " << settings.profileFile.getFullPathName() << std::endl;
+	}
+
+	std::cout << "Rendered " << (inputFiles.size() - failed) << " of " << inputFiles.size() << " files in " << juce::String(seconds, 2) << " s" << std::endl;
+
+	return failed > 0 ? 1 : 0;
+}